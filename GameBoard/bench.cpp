@@ -0,0 +1,158 @@
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <new>
+
+#include "ex4_header.h"
+
+// every allocation made by the process goes through here so it can be counted
+static std::size_t allocations = 0;
+
+void* operator new(std::size_t size) {
+    allocations++;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+static volatile long long sink = 0;
+
+template<class T> T makePiece(int i);
+template<> char makePiece<char>(int i) { return "RPSF"[i % 4]; }
+template<> int makePiece<int>(int i) { return i % 4; }
+template<> std::string makePiece<std::string>(int i) {
+    const static std::string names[] = { "Rock", "Paper", "Scissors", "Flag" };
+    return names[i % 4];
+}
+
+static long long checksum(char piece) { return piece; }
+static long long checksum(int piece) { return piece; }
+static long long checksum(const std::string& piece) { return piece.size(); }
+
+static void report(const std::string& board, const std::string& type, const std::string& name, long long ns,
+        long long ops, std::size_t allocs) {
+    std::cout << std::left << std::setw(10) << board << std::setw(8) << type << std::setw(32) << name
+        << std::right << std::fixed << std::setprecision(2)
+        << std::setw(12) << (ops ? double(ns) / ops : 0.0)
+        << std::setw(12) << (ops ? double(allocs) / ops : 0.0) << std::endl;
+}
+
+// runs func until enough time passed and prints ns and allocations per operation,
+// func performs opsPerCall operations each time it's called
+template<class FUNC>
+void measure(const std::string& board, const std::string& type, const std::string& name, long long opsPerCall, FUNC func) {
+    using clock = std::chrono::steady_clock;
+    const auto minDuration = std::chrono::milliseconds(100);
+    long long ops = 0;
+    const auto allocsBefore = allocations;
+    const auto start = clock::now();
+    auto elapsed = clock::duration::zero();
+    do {
+        func();
+        ops += opsPerCall;
+        elapsed = clock::now() - start;
+    } while (elapsed < minDuration);
+    report(board, type, name, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(), ops,
+        allocations - allocsBefore);
+}
+
+// the same with setup run before each call of func, neither its time nor its allocations count
+template<class SETUP, class FUNC>
+void measure(const std::string& board, const std::string& type, const std::string& name, long long opsPerCall,
+        SETUP setup, FUNC func) {
+    using clock = std::chrono::steady_clock;
+    const auto minDuration = std::chrono::milliseconds(100);
+    long long ops = 0;
+    std::size_t allocs = 0;
+    auto elapsed = clock::duration::zero();
+    do {
+        setup();
+        const auto allocsBefore = allocations;
+        const auto start = clock::now();
+        func();
+        elapsed += clock::now() - start;
+        allocs += allocations - allocsBefore;
+        ops += opsPerCall;
+    } while (elapsed < minDuration);
+    report(board, type, name, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(), ops, allocs);
+}
+
+template<class RANGE>
+void requireMatches(const std::string& board, const std::string& type, const std::string& name, RANGE&& range) {
+    long long matches = 0;
+    for (const auto& tup : range) {
+        (void)tup;
+        matches++;
+    }
+    if (matches > 0) return;
+    std::cout << "ERROR: " << board << " " << type << " " << name << " matches no piece" << std::endl;
+    std::exit(1);
+}
+
+template<int N, class T>
+void benchBoard(const std::string& type) {
+    using Board = GameBoard<N, N, T, 2>;
+    const auto board = std::to_string(N) + "x" + std::to_string(N);
+    auto gameBoard = std::make_unique<Board>();
+    // a quarter of the cells are occupied, alternating between the players
+    const int step = 4;
+    const long long numPieces = (Board::SIZE + step - 1) / step;
+    const auto piece = makePiece<T>(1);
+    const auto setPieces = [&] {
+        for (int i = 0; i < Board::SIZE; i += step) {
+            // by the ordinal of the occupied cell, i itself is always a multiple of step
+            const int k = i / step;
+            auto prev = gameBoard->setPiece(i / N, i % N, makePiece<T>(k), k % 2);
+            sink += prev != nullptr;
+        }
+    };
+    // onto empty cells, the board has no clear so every pass starts from a new one
+    measure(board, type, "setPiece(empty)", numPieces, [&] { gameBoard = std::make_unique<Board>(); }, setPieces);
+    // every later pass replaces the pieces of the one before
+    measure(board, type, "setPiece(replace)", numPieces, setPieces);
+    measure(board, type, "getPiece", Board::SIZE, [&] {
+        for (int i = 0; i < Board::SIZE; i++) {
+            auto pieceInfo = gameBoard->getPiece(i / N, i % N);
+            if (pieceInfo) sink += pieceInfo->first;
+        }
+    });
+    // iterations are measured per board traversal
+    measure(board, type, "iterate", 1, [&] {
+        for (const auto& tup : *gameBoard) sink += std::get<3>(tup);
+    });
+    // a filter that matches nothing would time an empty traversal
+    requireMatches(board, type, "allPiecesOfPlayer", gameBoard->allPiecesOfPlayer(1));
+    requireMatches(board, type, "allOccureneceOfPiece", gameBoard->allOccureneceOfPiece(piece));
+    requireMatches(board, type, "allOccureneceOfPieceForPlayer", gameBoard->allOccureneceOfPieceForPlayer(piece, 1));
+    measure(board, type, "allPiecesOfPlayer", 1, [&] {
+        for (const auto& tup : gameBoard->allPiecesOfPlayer(1)) sink += std::get<0>(tup);
+    });
+    measure(board, type, "allOccureneceOfPiece", 1, [&] {
+        for (const auto& tup : gameBoard->allOccureneceOfPiece(piece)) sink += checksum(std::get<2>(tup));
+    });
+    measure(board, type, "allOccureneceOfPieceForPlayer", 1, [&] {
+        for (const auto& tup : gameBoard->allOccureneceOfPieceForPlayer(piece, 1)) sink += std::get<1>(tup);
+    });
+}
+
+template<class T>
+void benchType(const std::string& type) {
+    benchBoard<10, T>(type);
+    benchBoard<100, T>(type);
+    benchBoard<1000, T>(type);
+}
+
+int main() {
+    std::cout << std::left << std::setw(10) << "board" << std::setw(8) << "piece" << std::setw(32) << "operation"
+        << std::right << std::setw(12) << "ns/op" << std::setw(12) << "allocs/op" << std::endl;
+    benchType<char>("char");
+    benchType<int>("int");
+    benchType<std::string>("string");
+    return 0;
+}
@@ -1,70 +1,164 @@
 #pragma once
 
-#include <functional>
 #include <utility>
+#include <new>
 #include <memory>
 #include <array>
 #include <tuple>
+#include <cstdint>
 
 template<class GAME_PIECE>
 using PieceInfo = std::unique_ptr<const std::pair<int, GAME_PIECE>>;
 
+// optional-like cell, the piece is stored inline and constructed only when the cell is occupied
+template<class GAME_PIECE>
+class PieceCell {
+public:
+    PieceCell() {}
+    PieceCell(const PieceCell& other) { if (other) emplace(other._piece, other._player); }
+    PieceCell& operator=(const PieceCell& other) {
+        if (this == &other) return *this;
+        if (other) emplace(other._piece, other._player); else reset();
+        return *this;
+    }
+    ~PieceCell() { reset(); }
+    explicit operator bool() const { return _hasPiece; }
+    int player() const { return _player; }
+    const GAME_PIECE& piece() const { return _piece; }
+    GAME_PIECE& piece() { return _piece; }
+    template<class T>
+    void emplace(T&& piece, int player) {
+        reset();
+        new (&_piece) GAME_PIECE(std::forward<T>(piece));
+        _player = player;
+        _hasPiece = true;
+    }
+    void reset() {
+        if (!_hasPiece) return;
+        _piece.~GAME_PIECE();
+        _hasPiece = false;
+    }
+private:
+    union { GAME_PIECE _piece; };
+    int _player = 0;
+    bool _hasPiece = false;
+};
+
+// fixed size bitset which can jump to the next set bit with count-trailing-zeros
+template<int SIZE>
+class OccupancySet {
+public:
+    void set(int i) { _words[i >> 6] |= uint64_t(1) << (i & 63); }
+    void reset(int i) { _words[i >> 6] &= ~(uint64_t(1) << (i & 63)); }
+    bool test(int i) const { return (_words[i >> 6] >> (i & 63)) & 1; }
+    // index of the first set bit at or after i, SIZE if there is none
+    int next(int i) const {
+        int word = i >> 6;
+        if (word >= WORDS) return SIZE;
+        uint64_t bits = _words[word] & (~uint64_t(0) << (i & 63));
+        while (!bits) {
+            if (++word == WORDS) return SIZE;
+            bits = _words[word];
+        }
+        return (word << 6) + __builtin_ctzll(bits);
+    }
+private:
+    const static int WORDS = (SIZE + 63) / 64;
+    std::array<uint64_t, WORDS> _words{};
+};
+
 template<int ROWS, int COLS, class GAME_PIECE, int NUM_PLAYERS = 2>
 class GameBoard {
 public:
     const static int SIZE = ROWS * COLS;
+    using Cell = PieceCell<GAME_PIECE>;
+    using Index = OccupancySet<SIZE>;
     PieceInfo<GAME_PIECE> getPiece(int row, int col) {
-        const auto& pieceInfo = _arr[row * COLS + col];
-        if (!pieceInfo) return nullptr;
-        return std::make_unique<const std::pair<int, GAME_PIECE>>(pieceInfo->first, pieceInfo->second);
+        const auto& cell = _arr[row * COLS + col];
+        if (!cell) return nullptr;
+        return std::make_unique<const std::pair<int, GAME_PIECE>>(cell.player(), cell.piece());
     }
     PieceInfo<GAME_PIECE> setPiece(int row, int col, GAME_PIECE piece, int player) {
-        auto pieceInfo = std::make_unique<const std::pair<int, GAME_PIECE>>(player, piece);
-        _arr[row * COLS + col].swap(pieceInfo);
+        const auto i = row * COLS + col;
+        auto& cell = _arr[i];
+        PieceInfo<GAME_PIECE> pieceInfo;
+        if (cell) {
+            pieceInfo = std::make_unique<const std::pair<int, GAME_PIECE>>(cell.player(), std::move(cell.piece()));
+            if (hasIndex(cell.player())) _playerCells[cell.player()].reset(i);
+        }
+        cell.emplace(std::move(piece), player);
+        _occupied.set(i);
+        if (hasIndex(player)) _playerCells[player].set(i);
         return pieceInfo;
     }
-    class iterator {
+    // non allocating access to a cell
+    const Cell& at(int row, int col) const { return _arr[row * COLS + col]; }
+    struct AnyPiece {
+        bool operator()(const Cell&) const { return true; }
+    };
+    struct OfPlayer {
+        int player;
+        bool operator()(const Cell& cell) const { return cell.player() == player; }
+    };
+    struct OfPiece {
+        GAME_PIECE piece;
+        bool operator()(const Cell& cell) const { return cell.piece() == piece; }
+    };
+    struct OfPieceAndPlayer {
+        GAME_PIECE piece;
+        int player;
+        bool operator()(const Cell& cell) const { return cell.player() == player && cell.piece() == piece; }
+    };
+    // walks only the set bits of an occupancy index, the predicate is a template
+    // parameter so the remaining filtering is inlined into the loop
+    template<class PRED>
+    class filtered_iterator {
     public:
-        using predicate_type = std::function<bool(const PieceInfo<GAME_PIECE>&)>;
-        iterator(const GameBoard& board, const predicate_type& pred, int i = 0) :
-            _board(board), _pred(pred), _i(--i) {
-            do _i++; while (_i < SIZE && (!_board._arr[_i] || !_pred(_board._arr[_i])));
+        using predicate_type = PRED;
+        filtered_iterator(const GameBoard& board, const Index& cells, const PRED& pred, int i = 0) :
+            _board(board), _cells(cells), _pred(pred), _i(i) {
+            skip();
         }
-        iterator& operator++() {
-            do _i++; while (_i < SIZE && (!_board._arr[_i] || !_pred(_board._arr[_i])));
+        filtered_iterator& operator++() {
+            _i++;
+            skip();
             return *this;
         }
         const std::tuple<int, int, GAME_PIECE, int> operator*() {
-            const auto& player = _board._arr[_i]->first;
-            const auto& piece = _board._arr[_i]->second;
-            return std::make_tuple(_i / COLS, _i % COLS, piece, player);
+            const auto& cell = _board._arr[_i];
+            return std::make_tuple(_i / COLS, _i % COLS, cell.piece(), cell.player());
         }
-        bool operator==(const iterator& other) { return _i == other._i; }
-        bool operator!=(const iterator& other) { return !(*this == other); }
-        iterator begin() { return iterator(_board, _pred, 0); }
-        iterator end() { return iterator(_board, _pred, SIZE); }
+        bool operator==(const filtered_iterator& other) { return _i == other._i; }
+        bool operator!=(const filtered_iterator& other) { return !(*this == other); }
+        filtered_iterator begin() { return filtered_iterator(_board, _cells, _pred, 0); }
+        filtered_iterator end() { return filtered_iterator(_board, _cells, _pred, SIZE); }
     private:
+        void skip() {
+            _i = _cells.next(_i);
+            while (_i < SIZE && !_pred(_board._arr[_i])) _i = _cells.next(_i + 1);
+        }
         const GameBoard& _board;
-        const predicate_type _pred;
+        const Index& _cells;
+        const PRED _pred;
         int _i;
     };
-    iterator begin() { return iterator(*this, [](const auto&) { return true; }, 0); }
-    iterator end() { return iterator(*this, [](const auto&) { return true; }, _arr.size()); }
-    iterator allPiecesOfPlayer(int playerNum) {
-        return iterator(*this, [playerNum](const auto& pieceInfo) {
-            return pieceInfo->first == playerNum;
-        });
+    using iterator = filtered_iterator<AnyPiece>;
+    iterator begin() { return iterator(*this, _occupied, AnyPiece(), 0); }
+    iterator end() { return iterator(*this, _occupied, AnyPiece(), SIZE); }
+    filtered_iterator<OfPlayer> allPiecesOfPlayer(int playerNum) {
+        return filtered_iterator<OfPlayer>(*this, cellsOf(playerNum), OfPlayer{ playerNum });
     }
-    iterator allOccureneceOfPiece(GAME_PIECE piece) {
-        return iterator(*this, [piece](const auto& pieceInfo) {
-            return pieceInfo->second == piece;
-        });
+    filtered_iterator<OfPiece> allOccureneceOfPiece(GAME_PIECE piece) {
+        return filtered_iterator<OfPiece>(*this, _occupied, OfPiece{ piece });
     }
-    iterator allOccureneceOfPieceForPlayer(GAME_PIECE piece, int playerNum) {
-        return iterator(*this, [playerNum, piece](const auto& pieceInfo) {
-            return pieceInfo->first == playerNum && pieceInfo->second == piece;
-        });
+    filtered_iterator<OfPieceAndPlayer> allOccureneceOfPieceForPlayer(GAME_PIECE piece, int playerNum) {
+        return filtered_iterator<OfPieceAndPlayer>(*this, cellsOf(playerNum), OfPieceAndPlayer{ piece, playerNum });
     }
 private:
-    std::array<PieceInfo<GAME_PIECE>, SIZE> _arr;
-};
\ No newline at end of file
+    // players are indexed both 0-based and 1-based, any other player number falls back to _occupied
+    static bool hasIndex(int player) { return player >= 0 && player <= NUM_PLAYERS; }
+    const Index& cellsOf(int player) const { return hasIndex(player) ? _playerCells[player] : _occupied; }
+    std::array<Cell, SIZE> _arr;
+    Index _occupied;
+    std::array<Index, NUM_PLAYERS + 1> _playerCells;
+};
@@ -58,8 +58,84 @@ static bool test2() {
     return true;
 }
 
+static bool test3() {
+    GameBoard<5, 5, string, 2> board;
+    ASSERT_FALSE(board.getPiece(2, 3));
+    ASSERT_FALSE(board.setPiece(2, 3, "Rock", 0));
+    auto prev = board.setPiece(2, 3, "Paper", 1);
+    ASSERT_TRUE(prev && prev->first == 0 && prev->second == "Rock");
+    auto piece = board.getPiece(2, 3);
+    ASSERT_TRUE(piece && piece->first == 1 && piece->second == "Paper");
+    board.setPiece(0, 0, "Rock", 0);
+    board.setPiece(4, 4, "Paper", 0);
+    int count = 0;
+    for (const auto& tup : board.allPiecesOfPlayer(0)) {
+        ASSERT_TRUE(get<3>(tup) == 0);
+        count++;
+    }
+    ASSERT_TRUE(count == 2);
+    count = 0;
+    for (const auto& tup : board.allOccureneceOfPiece("Paper")) {
+        ASSERT_TRUE(get<2>(tup) == "Paper");
+        count++;
+    }
+    ASSERT_TRUE(count == 2);
+    count = 0;
+    for (const auto& tup : board.allOccureneceOfPieceForPlayer("Paper", 1)) {
+        ASSERT_TRUE(get<0>(tup) == 2 && get<1>(tup) == 3);
+        count++;
+    }
+    ASSERT_TRUE(count == 1);
+    return true;
+}
+
+static bool test4() {
+    GameBoard<100, 100, char, 2> board;
+    board.setPiece(0, 0, 'R', 1);
+    board.setPiece(0, 63, 'P', 2);
+    board.setPiece(0, 64, 'R', 2);
+    board.setPiece(99, 99, 'S', 7);
+    board.setPiece(0, 63, 'S', 1); // moves the cell from player 2 to player 1
+    int rows[] = { 0, 0 };
+    int cols[] = { 0, 63 };
+    int count = 0;
+    for (const auto& tup : board.allPiecesOfPlayer(1)) {
+        ASSERT_TRUE(count < 2);
+        ASSERT_TRUE(get<0>(tup) == rows[count] && get<1>(tup) == cols[count]);
+        count++;
+    }
+    ASSERT_TRUE(count == 2);
+    count = 0;
+    for (const auto& tup : board.allPiecesOfPlayer(2)) {
+        ASSERT_TRUE(get<1>(tup) == 64);
+        count++;
+    }
+    ASSERT_TRUE(count == 1);
+    count = 0;
+    for (const auto& tup : board.allPiecesOfPlayer(7)) {
+        ASSERT_TRUE(get<0>(tup) == 99 && get<1>(tup) == 99);
+        count++;
+    }
+    ASSERT_TRUE(count == 1);
+    count = 0;
+    for (const auto& tup : board.allOccureneceOfPiece('S')) {
+        (void)tup;
+        count++;
+    }
+    ASSERT_TRUE(count == 2);
+    count = 0;
+    for (const auto& tup : board) {
+        (void)tup;
+        count++;
+    }
+    ASSERT_TRUE(count == 4);
+    return true;
+}
+
 int main() {
     RUN_TEST(test1);
     RUN_TEST(test2);
+    RUN_TEST(test3);
+    RUN_TEST(test4);
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "DecoratedPlayerAlgorithm.h"
+#include "AllocAccounting.h"
+
+
+// Runs each call of a player, its construction aside, with the allocations charged to its
+// algorithm's slot. With a cap, once the algorithm's live memory on this worker exceeds it
+// the player forfeits: its positioning turns invalid and its moves become nullptr.
+class AccountedCalls : public PlayerPolicy {
+public:
+    AccountedCalls(unsigned int slot, std::size_t cap) : _slot(slot), _cap(cap) {}
+    class Scope : public AllocAccounting::Scope {
+    public:
+        explicit Scope(const AccountedCalls& policy) : AllocAccounting::Scope(policy._slot) {}
+    };
+    void afterPositions(std::vector<unique_ptr<PiecePosition>>& positions) {
+        if (overCap()) positions.emplace_back(nullptr);
+    }
+    void afterMove(unique_ptr<Move>& move) {
+        if (overCap()) move.reset();
+    }
+    void afterTurn(TurnReply& reply) {
+        if (overCap()) reply = TurnReply(); // from (0, 0), an invalid move
+    }
+private:
+    bool overCap() {
+        if (!_exceededCap && _cap > 0 && AllocAccounting::threadLive(_slot) > static_cast<long long>(_cap)) {
+            _exceededCap = true;
+            AllocAccounting::countForfeit(_slot);
+        }
+        return _exceededCap;
+    }
+    unsigned int _slot;
+    std::size_t _cap; // bytes, 0 for no cap
+    bool _exceededCap = false;
+};
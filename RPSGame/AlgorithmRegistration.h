@@ -6,13 +6,24 @@
 
 #include "PlayerAlgorithm.h"
 
+// optional metadata registered with an algorithm
+struct AlgorithmInfo {
+    bool deterministic = false; // plays the same given the player index and the opponent's moves
+};
+
 class AlgorithmRegistration {
 public:
     AlgorithmRegistration(std::string id, std::function<std::unique_ptr<PlayerAlgorithm>()>);
+    AlgorithmRegistration(std::string id, std::function<std::unique_ptr<PlayerAlgorithm>()>, AlgorithmInfo info);
 };
 
 #define REGISTER_ALGORITHM(ID) \
 AlgorithmRegistration register_me_##ID \
     (#ID, []{return std::make_unique<RSPPlayer_##ID>();} );
 
+// games between two deterministic algorithms are played once and their result reused
+#define REGISTER_DETERMINISTIC_ALGORITHM(ID) \
+AlgorithmRegistration register_me_##ID \
+    (#ID, []{return std::make_unique<RSPPlayer_##ID>();}, AlgorithmInfo{ true } );
+
 #endif
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include <cstdlib>
+#include <cstdint>
+#include <new>
+#include <map>
+#include <mutex>
+#include "AllocAccounting.h"
+
+// Each block starts with a header holding its size and slot, 16 bytes so the memory
+// returned after it keeps malloc's alignment.
+struct Header {
+    uint64_t size;
+    uint32_t slot;
+    uint32_t reserved;
+};
+static_assert(sizeof(Header) == 16, "the header must keep the alignment of malloc");
+
+// constant initialized, usable by allocations made before main and during static destruction
+static AllocAccounting::Counters counters[AllocAccounting::MAX_SLOTS];
+static thread_local unsigned int currentSlot = 0;
+static thread_local long long threadLiveBytes[AllocAccounting::MAX_SLOTS];
+
+AllocAccounting::Scope::Scope(unsigned int slot) : _previous(currentSlot) {
+    currentSlot = slot;
+}
+
+AllocAccounting::Scope::~Scope() {
+    currentSlot = _previous;
+}
+
+unsigned int AllocAccounting::slot(const std::string& id) {
+    static std::mutex mutex;
+    static std::map<std::string, unsigned int> slots;
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto it = slots.find(id);
+    if (it != slots.end()) return it->second;
+    if (slots.size() + 1 >= MAX_SLOTS) return NO_SLOT;
+    const unsigned int slot = slots.size() + 1;
+    slots[id] = slot;
+    return slot;
+}
+
+const AllocAccounting::Counters& AllocAccounting::counters(unsigned int slot) {
+    return ::counters[slot];
+}
+
+long long AllocAccounting::threadLive(unsigned int slot) {
+    return threadLiveBytes[slot];
+}
+
+void AllocAccounting::countForfeit(unsigned int slot) {
+    ::counters[slot].forfeits.fetch_add(1, std::memory_order_relaxed);
+}
+
+void* AllocAccounting::allocate(std::size_t size) {
+    auto header = static_cast<Header*>(std::malloc(sizeof(Header) + size));
+    if (!header) return nullptr;
+    const auto slot = currentSlot;
+    header->size = size;
+    header->slot = slot;
+    auto& slotCounters = ::counters[slot];
+    slotCounters.allocs.fetch_add(1, std::memory_order_relaxed);
+    slotCounters.bytes.fetch_add(size, std::memory_order_relaxed);
+    const long long live = slotCounters.live.fetch_add(size, std::memory_order_relaxed) + size;
+    auto peak = slotCounters.peak.load(std::memory_order_relaxed);
+    while (live > peak && !slotCounters.peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+    threadLiveBytes[slot] += size;
+    return header + 1;
+}
+
+void AllocAccounting::deallocate(void* p) noexcept {
+    if (!p) return;
+    auto header = static_cast<Header*>(p) - 1;
+    ::counters[header->slot].live.fetch_sub(header->size, std::memory_order_relaxed);
+    threadLiveBytes[header->slot] -= header->size;
+    std::free(header);
+}
+
+#ifdef ALLOC_ACCOUNTING
+
+void* operator new(std::size_t size) {
+    auto p = AllocAccounting::allocate(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return AllocAccounting::allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return AllocAccounting::allocate(size);
+}
+
+void operator delete(void* p) noexcept {
+    AllocAccounting::deallocate(p);
+}
+
+void operator delete[](void* p) noexcept {
+    AllocAccounting::deallocate(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    AllocAccounting::deallocate(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+    AllocAccounting::deallocate(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    AllocAccounting::deallocate(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    AllocAccounting::deallocate(p);
+}
+
+#endif
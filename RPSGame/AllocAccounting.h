@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+#include <atomic>
+#include <cstddef>
+
+
+// Opt-in allocation accounting, built with "make ALLOC_ACCOUNTING=1" (after a make clean).
+// The executable then replaces operator new and delete, which exports.map exports to the
+// player libraries as well, and charges each allocation to the algorithm whose code is
+// running on the allocating thread (see AccountedPlayerAlgorithm). A free is charged back
+// to the algorithm that made the allocation, whichever thread frees it.
+class AllocAccounting {
+public:
+#ifdef ALLOC_ACCOUNTING
+    static constexpr bool compiled = true;
+#else
+    static constexpr bool compiled = false;
+#endif
+    static const unsigned int MAX_SLOTS = 256; // slot 0 is the engine's
+    static const unsigned int NO_SLOT = MAX_SLOTS; // of an algorithm past the last slot, not accounted
+    struct Counters {
+        std::atomic_ullong allocs{ 0 };
+        std::atomic_ullong bytes{ 0 }; // allocated in total
+        std::atomic_llong live{ 0 };
+        std::atomic_llong peak{ 0 };
+        std::atomic_ullong forfeits{ 0 }; // games lost over the cap
+    };
+    // sets the slot charged on this thread until the scope ends
+    class Scope {
+    public:
+        explicit Scope(unsigned int slot);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    private:
+        unsigned int _previous;
+    };
+    static unsigned int slot(const std::string& id); // NO_SLOT when all slots are taken
+    static const Counters& counters(unsigned int slot);
+    static long long threadLive(unsigned int slot); // the slot's live bytes allocated or freed on this thread
+    static void countForfeit(unsigned int slot);
+    static void* allocate(std::size_t size);
+    static void deallocate(void* p) noexcept;
+};
@@ -0,0 +1,55 @@
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <cstdio>
+#include "AutoParams.h"
+
+// File layout, text:
+//   "RPSPARAMS1"
+//   a line per parameter: name value
+// parameters missing from the file keep their defaults
+
+const std::string PARAMS_MAGIC = "RPSPARAMS1";
+
+const std::vector<AutoParams::Field>& AutoParams::fields() {
+    static const std::vector<Field> fields = {
+        { "scout_distance", &AutoParams::scoutDistance, 0, 4, 0.5 },
+        { "attack_weaker", &AutoParams::attackWeaker, -10, 10, 1 },
+        { "attack_stronger", &AutoParams::attackStronger, -10, 10, 1 },
+        { "attack_unknown", &AutoParams::attackUnknown, -10, 10, 1 },
+        { "attack_moved", &AutoParams::attackMoved, -10, 10, 1 },
+        { "approach", &AutoParams::approach, -10, 10, 1 },
+        { "escape", &AutoParams::escape, -10, 10, 1 },
+    };
+    return fields;
+}
+
+bool AutoParams::save(const std::string& fname) const {
+    // written aside and renamed like a profile, a reader never sees half a file
+    const auto tmpName = fname + ".tmp";
+    {
+        std::ofstream os(tmpName, std::ios::trunc);
+        os << PARAMS_MAGIC << "\n" << std::setprecision(std::numeric_limits<double>::max_digits10);
+        for (const auto& field : fields()) os << field.name << " " << this->*field.member << "\n";
+        if (!os.flush()) return false;
+    }
+    return std::rename(tmpName.c_str(), fname.c_str()) == 0;
+}
+
+bool AutoParams::load(const std::string& fname) {
+    std::ifstream is(fname);
+    std::string magic;
+    if (!(is >> magic) || magic != PARAMS_MAGIC) return false;
+    std::string name;
+    double value;
+    while (is >> name >> value) {
+        bool known = false;
+        for (const auto& field : fields()) {
+            if (name != field.name) continue;
+            this->*field.member = value;
+            known = true;
+        }
+        if (!known) return false;
+    }
+    return is.eof();
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+
+// tunable constants of AutoPlayerAlgorithm, the defaults play like the hand-picked rules
+// (scan order placement and moves), the tune binary searches better ones
+struct AutoParams {
+    double scoutDistance = 0; // squares the three outlying papers are placed away from their corners
+    // added to the score of a move that attacks
+    double attackWeaker = 0; // a revealed opponent piece ours beats
+    double attackStronger = 0; // a revealed opponent piece that beats ours
+    double attackUnknown = 0; // an unrevealed opponent piece
+    double attackMoved = 0; // in addition, an unrevealed one that moved, so not a bomb or the flag
+    double approach = 0; // per square the move closes on the nearest opponent piece
+    double escape = 0; // of a piece a revealed opponent piece next to it beats
+    struct Field {
+        const char* name;
+        double AutoParams::* member;
+        double min;
+        double max;
+        double step; // of the perturbations while tuning, about the change that makes a difference
+    };
+    static const std::vector<Field>& fields();
+    bool save(const std::string& fname) const;
+    bool load(const std::string& fname);
+};
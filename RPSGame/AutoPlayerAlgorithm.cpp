@@ -1,18 +1,49 @@
 #include <algorithm>
-#include <fstream>
 #include <iomanip>
 #include <cctype>
 #include <set>
+#include <cstdlib>
+#include <cmath>
+#include <limits>
 #include "AutoPlayerAlgorithm.h"
 #include "AlgorithmRegistration.h"
+#include "Tablebase.h"
+#include "BoardEval.h"
+#include "Log.h"
 
-std::fstream nullstream;
-#define DEBUG(x) do { nullstream << "RSPPlayer203521984::" << __func__ << "\t\t" << x << std::endl; } while (0)
+#define DEBUG(x) LOG_DEBUG("RSPPlayer203521984::" << __func__ << "\t\t" << x)
 
 
 const std::set<char> MOVABLE_PIECES = { 'R', 'P', 'S' };
 
-AutoPlayerAlgorithm::AutoPlayerAlgorithm() : _rg(std::mt19937(std::random_device{}())) {
+// shared by the players of the process, mapped on first use
+static const Tablebase& tablebase() {
+    static Tablebase tablebase;
+    static const bool opened = [] {
+        const char* fname = std::getenv("RPS_TABLEBASE");
+        return fname && tablebase.open(fname);
+    }();
+    (void)opened;
+    return tablebase;
+}
+
+// shared by the players of the process, loaded on first use
+static const AutoParams& params() {
+    static const AutoParams params = [] {
+        AutoParams params;
+        const char* fname = std::getenv("RPS_PARAMS");
+        if (fname && !params.load(fname)) {
+            LOG_WARNING("can't read parameters from " << fname << ", playing with the defaults");
+            params = AutoParams();
+        }
+        return params;
+    }();
+    return params;
+}
+
+AutoPlayerAlgorithm::AutoPlayerAlgorithm() : AutoPlayerAlgorithm(params()) {}
+
+AutoPlayerAlgorithm::AutoPlayerAlgorithm(const AutoParams& params) : _params(params), _rg(std::mt19937(std::random_device{}())) {
     _numPieces = {
         { 'F', 1 },
         { 'R', 2 },
@@ -59,6 +90,7 @@ void AutoPlayerAlgorithm::notifyOnOpponentMove(const Move& move) {
     if (_board[from].player != _opponent) DEBUG("source pos not of opponent piece");
     if (_board[to].player == _opponent) DEBUG("destination pos of opponent piece");
     _board[to] = _board[from];
+    _board[to].piece.moved = true;
     _board[from] = { Piece(), 0 };
 }
 
@@ -73,7 +105,7 @@ void AutoPlayerAlgorithm::notifyFightResult(const FightInfo& fightInfo) {
         _board[pos] = { { ourPiece, ' ' }, _player };
     } else if (winner == _opponent) {
         _numPieces[ourPiece]--;
-        _board[pos] = { { (char)std::tolower(oppPiece), ' ' }, _opponent };
+        _board[pos] = { { (char)std::tolower(oppPiece), ' ', _board[pos].piece.moved }, _opponent };
     } else if (winner == 0) {
         _numPieces[ourPiece]--;
         _board[pos] = { Piece(), 0 };
@@ -82,9 +114,10 @@ void AutoPlayerAlgorithm::notifyFightResult(const FightInfo& fightInfo) {
 
 std::unique_ptr<Move> AutoPlayerAlgorithm::getMove() {
     // DEBUG(std::endl << _board);
-    const auto from = getPosToMoveFrom();
-    if (from == nullptr) return nullptr;
-    const auto to = getBestNeighbor(*from);
+    DEBUG("evaluation " << evaluate());
+    std::unique_ptr<GamePoint> from;
+    std::unique_ptr<GamePoint> to;
+    if (!getTablebaseMove(from, to) && !getBestMove(from, to)) return nullptr;
     if (_board[*to].player != _opponent) { // there will be no fight
         _board[*to] = _board[*from];
     }
@@ -102,30 +135,231 @@ std::unique_ptr<JokerChange> AutoPlayerAlgorithm::getJokerChange() {
             if (_board[{x, y}].piece.type != 'J') continue;
             if (_board[{x, y}].player != _player) continue;
             if (_board[{x, y}].piece.jokerType != 'B') continue; // it can move
+            _board[{x, y}].piece.jokerType = 'S'; // so getMove moves it from now on
             return std::make_unique<GameJokerChange>(GamePoint(x + 1, y + 1), 'S');
         }
     }
     return nullptr;
 }
 
-std::unique_ptr<GamePoint> AutoPlayerAlgorithm::getPosToMoveFrom() const {
-    for (auto y = 0; y < _board.M; y++) {
-        for (auto x = 0; x < _board.N; x++) {
-            if (_board[{x, y}].player != _player) continue;
-            if (!isMovable(_board[{x, y}].piece)) continue;
-            if (hasValidMove(x + 1, y + 1)) {
-                return std::make_unique<GamePoint>(x + 1, y + 1);
+void AutoPlayerAlgorithm::playTurn(const TurnEvent* events, std::size_t numEvents, TurnReply& reply) {
+    for (std::size_t i = 0; i < numEvents; i++) {
+        const auto& event = events[i];
+        if (event.type == TurnEvent::OpponentMove) {
+            notifyOnOpponentMove(GameMove(event.fromX, event.fromY, event.toX, event.toY));
+        } else {
+            notifyFightResult(GameFightInfo(GamePoint(event.toX, event.toY), event.piece1, event.piece2, event.winner));
+        }
+    }
+    const auto move = getMove();
+    if (move) {
+        reply.fromX = move->getFrom().getX();
+        reply.fromY = move->getFrom().getY();
+        reply.toX = move->getTo().getX();
+        reply.toY = move->getTo().getY();
+    }
+    const auto jokerChange = getJokerChange();
+    if (jokerChange) {
+        reply.jokerX = jokerChange->getJokerChangePosition().getX();
+        reply.jokerY = jokerChange->getJokerChangePosition().getY();
+        reply.jokerRep = jokerChange->getJokerNewRep();
+    }
+}
+
+// the board from our side, see BoardEval
+int AutoPlayerAlgorithm::evaluate() const {
+    BoardEval::Board board;
+    for (auto x = 0; x < _board.N; x++) {
+        for (auto y = 0; y < _board.M; y++) {
+            const auto& entry = _board[{x, y}];
+            if (entry.player == 0) continue;
+            const auto square = BoardEval::Board::square(x + 1, y + 1);
+            const auto type = static_cast<char>(std::toupper(entry.piece.type == 'J' ? entry.piece.jokerType : entry.piece.type));
+            if (entry.player == _player) {
+                board[square] = type == 'R' ? BoardEval::OurR : (type == 'P' ? BoardEval::OurP :
+                    (type == 'S' ? BoardEval::OurS : BoardEval::OurOther));
+                if (entry.piece.type == 'F') board.flag = square;
+            } else {
+                // a revealed bomb or flag can't threaten either, it counts as unknown material
+                board[square] = type == 'R' ? BoardEval::TheirR : (type == 'P' ? BoardEval::TheirP :
+                    (type == 'S' ? BoardEval::TheirS : BoardEval::TheirUnknown));
             }
         }
     }
-    return nullptr;
+    return BoardEval::evaluate(board);
 }
 
-bool AutoPlayerAlgorithm::hasValidMove(int x, int y) const {
-    for (const auto& pos : validPermutations(GamePoint(x, y))) {
-        if (_board[pos].player != _player) return true;
+// Against an opponent with two pieces of which one moved, the other one is the opponent's
+// flag and each of our movable pieces with the two opponent pieces is a tablebase position,
+// our other pieces aside. A defender that wasn't revealed in a fight may be of any type, so
+// each move is scored by its worst case. The table doesn't know our flag, so a win counts
+// only when it ends the game before the defender can get to our flag, and a draw only when
+// it can't get there at all. A move is taken when it wins, or with a single movable piece
+// left when it keeps the draw.
+bool AutoPlayerAlgorithm::getTablebaseMove(std::unique_ptr<GamePoint>& from, std::unique_ptr<GamePoint>& to) const {
+    if (!tablebase().isOpen()) return false;
+    std::vector<std::pair<int, char>> attackers; // square and type
+    int f = -1;
+    int d = -1;
+    std::vector<char> defenders = { 'R', 'P', 'S' };
+    unsigned int numOpponent = 0;
+    for (auto x = 0; x < _board.N; x++) {
+        for (auto y = 0; y < _board.M; y++) {
+            const auto& entry = _board[{x, y}];
+            const auto square = x * Tablebase::N + y;
+            if (entry.player == _player && isMovable(entry.piece)) {
+                attackers.emplace_back(square, entry.piece.type == 'J' ? entry.piece.jokerType : entry.piece.type);
+            } else if (entry.player == _opponent) {
+                numOpponent++;
+                const auto type = static_cast<char>(std::toupper(entry.piece.type));
+                const bool movable = entry.piece.moved || MOVABLE_PIECES.count(type);
+                if (movable && d < 0) {
+                    d = square;
+                    if (MOVABLE_PIECES.count(type)) defenders = { type };
+                } else if (!movable && f < 0 && (type == 'U' || type == 'F')) {
+                    f = square;
+                } else {
+                    return false;
+                }
+            }
+        }
+    }
+    if (numOpponent != 2 || attackers.empty() || f < 0 || d < 0) return false;
+    // the ply, counted from the defender's next move, it would take our flag on
+    const auto reach = flagDistance(GamePoint(d / Tablebase::N + 1, d % Tablebase::N + 1));
+    const int reachPlies = reach < 0 ? Tablebase::PLIES + 1 : 2 * reach - 1;
+    int bestScore = attackers.size() == 1 ? -1 : 0;
+    for (const auto& attacker : attackers) {
+        const int a = attacker.first;
+        for (const auto& pos : validPermutations(GamePoint(a / Tablebase::N + 1, a % Tablebase::N + 1))) {
+            if (_board[pos].player == _player) continue;
+            const int next = (pos.getX() - 1) * Tablebase::N + (pos.getY() - 1);
+            // 1000 - plies for a win, 0 for a draw and plies - 1000 for a loss
+            int score = 1000;
+            for (const auto defender : defenders) {
+                int defenderScore;
+                if (next == f) {
+                    defenderScore = 999;
+                } else if (next == d) {
+                    defenderScore = Tablebase::fight(attacker.second, defender) * 999;
+                } else {
+                    const auto value = tablebase().probe(attacker.second, next, f, defender, d, Tablebase::Defender);
+                    const int plies = (value & Tablebase::PLIES) + 1;
+                    defenderScore = value == 0 ? 0 : ((value & Tablebase::LOSS) ? 1000 - plies : plies - 1000);
+                    // the defender loses within the table's plies whatever it does, unless it takes our flag first
+                    const bool safe = (value & Tablebase::LOSS) ? plies - 1 < reachPlies : reach < 0;
+                    if (!safe) defenderScore = -1000;
+                }
+                score = std::min(score, defenderScore);
+            }
+            if (score > bestScore) {
+                bestScore = score;
+                from = std::make_unique<GamePoint>(a / Tablebase::N + 1, a % Tablebase::N + 1);
+                to = std::make_unique<GamePoint>(pos);
+            }
+        }
+    }
+    if (!from) return false;
+    DEBUG("tablebase move, score " << bestScore);
+    return true;
+}
+
+// moves an opponent piece at pos needs to take our flag, -1 when it can't: a bomb it moves
+// onto dies with it, our other pieces may lose the fight and don't stop it
+int AutoPlayerAlgorithm::flagDistance(const GamePoint& pos) const {
+    GameBoard<int> distances;
+    for (auto x = 1; x <= _board.N; x++) {
+        for (auto y = 1; y <= _board.M; y++) distances[GamePoint(x, y)] = { -1, 0 };
+    }
+    std::vector<GamePoint> queue = { pos };
+    distances[pos].piece = 0;
+    for (std::size_t i = 0; i < queue.size(); i++) {
+        const auto current = queue[i]; // a copy, the queue grows
+        const auto& entry = _board[current];
+        if (entry.player == _player && entry.piece.type == 'F') return distances[current].piece;
+        for (const auto& next : validPermutations(current)) {
+            const auto& piece = _board[next].piece;
+            const bool bomb = _board[next].player == _player && (piece.type == 'J' ? piece.jokerType : piece.type) == 'B';
+            if (bomb || distances[next].piece >= 0) continue;
+            distances[next].piece = distances[current].piece + 1;
+            queue.push_back(next);
+        }
     }
-    return false;
+    return -1;
+}
+
+// the move of the highest score, the first one in scan order among equal ones
+bool AutoPlayerAlgorithm::getBestMove(std::unique_ptr<GamePoint>& from, std::unique_ptr<GamePoint>& to) const {
+    std::vector<GamePoint> opponents;
+    if (_params.approach != 0) {
+        for (auto y = 1; y <= _board.M; y++) {
+            for (auto x = 1; x <= _board.N; x++) {
+                if (_board[GamePoint(x, y)].player == _opponent) opponents.emplace_back(x, y);
+            }
+        }
+    }
+    double bestScore = 0;
+    for (auto y = 1; y <= _board.M; y++) {
+        for (auto x = 1; x <= _board.N; x++) {
+            const GamePoint pos(x, y);
+            if (_board[pos].player != _player) continue;
+            if (!isMovable(_board[pos].piece)) continue;
+            for (const auto& next : validPermutations(pos)) {
+                if (_board[next].player == _player) continue;
+                const auto score = scoreMove(pos, next, opponents);
+                if (from && score <= bestScore) continue;
+                bestScore = score;
+                from = std::make_unique<GamePoint>(pos);
+                to = std::make_unique<GamePoint>(next);
+            }
+        }
+    }
+    return from != nullptr;
+}
+
+// opponents are the squares of the opponent's pieces, only needed with the approach parameter
+double AutoPlayerAlgorithm::scoreMove(const GamePoint& from, const GamePoint& to, const std::vector<GamePoint>& opponents) const {
+    const auto& piece = _board[from].piece;
+    const auto ours = piece.type == 'J' ? piece.jokerType : piece.type;
+    double score = 0;
+    const auto& target = _board[to];
+    if (target.player == _opponent) {
+        const auto theirs = static_cast<char>(std::toupper(target.piece.type));
+        if (theirs == 'U') {
+            score += _params.attackUnknown + (target.piece.moved ? _params.attackMoved : 0);
+        } else {
+            const auto outcome = fightOutcome(ours, theirs);
+            score += outcome > 0 ? _params.attackWeaker : (outcome < 0 ? _params.attackStronger : 0);
+        }
+    }
+    if (_params.approach != 0) score += _params.approach * (distance(from, opponents) - distance(to, opponents));
+    if (_params.escape != 0) {
+        for (const auto& pos : validPermutations(from)) {
+            const auto& entry = _board[pos];
+            if (entry.player != _opponent || entry.piece.type == 'u') continue;
+            if (fightOutcome(ours, static_cast<char>(std::toupper(entry.piece.type))) < 0) {
+                score += _params.escape;
+                break;
+            }
+        }
+    }
+    return score;
+}
+
+// in king moves to the nearest of points
+int AutoPlayerAlgorithm::distance(const GamePoint& pos, const std::vector<GamePoint>& points) {
+    int distance = std::numeric_limits<int>::max();
+    for (const auto& point : points) {
+        distance = std::min(distance, std::max(std::abs(point.getX() - pos.getX()), std::abs(point.getY() - pos.getY())));
+    }
+    return distance;
+}
+
+// of our piece of type ours moving onto a revealed opponent piece, see Tablebase::fight
+int AutoPlayerAlgorithm::fightOutcome(char ours, char theirs) {
+    if (theirs == 'F') return 1;
+    if (theirs == 'B') return 0; // both die
+    return Tablebase::fight(ours, theirs);
 }
 
 bool AutoPlayerAlgorithm::isMovable(const Piece& piece) const {
@@ -134,14 +368,6 @@ bool AutoPlayerAlgorithm::isMovable(const Piece& piece) const {
     return MOVABLE_PIECES.count(type) || (type == 'J' && MOVABLE_PIECES.count(jokerType));
 }
 
-std::unique_ptr<GamePoint> AutoPlayerAlgorithm::getBestNeighbor(const Point& from) const {
-    for (const auto& pos : validPermutations(from)) {
-        if (_board[pos].player == _player) continue;
-        return std::make_unique<GamePoint>(pos);
-    }
-    return nullptr;
-}
-
 std::vector<GamePoint> AutoPlayerAlgorithm::validPermutations(const Point& from) const {
     std::vector<GamePoint> vec;
     auto x = from.getX();
@@ -158,7 +384,8 @@ std::vector<GamePoint> AutoPlayerAlgorithm::validPermutations(const Point& from)
 }
 
 void AutoPlayerAlgorithm::initBoard() {
-    // flag in edge surrounded by bombs & joker
+    // the pieces stay in the player's half, rows 0 to 4 for player 1, so two AutoPlayers don't
+    // collide while positioning; flag in the back corner surrounded by bombs & joker
     _board[{0, 0}] = { { 'F', 'B' }, _player };
     _board[{0, 1}] = { { 'B', 'B' }, _player };
     _board[{1, 0}] = { { 'B', 'B' }, _player };
@@ -167,22 +394,26 @@ void AutoPlayerAlgorithm::initBoard() {
     _board[{1, 2}] = { { 'J', 'B' }, _player };
     _board[{2, 2}] = { { 'R', 'B' }, _player };
     _board[{2, 3}] = { { 'R', 'B' }, _player };
-    _board[{9, 9}] = { { 'P', 'B' }, _player };
     _board[{2, 0}] = { { 'P', 'B' }, _player };
-    _board[{9, 0}] = { { 'P', 'B' }, _player };
     _board[{1, 3}] = { { 'P', 'B' }, _player };
-    _board[{0, 9}] = { { 'P', 'B' }, _player };
+    // the outlying papers, in the far back corner and the front corners, up to 4 squares
+    // toward the center they stay clear of the others
+    const auto scout = static_cast<int>(std::lround(std::min(std::max(_params.scoutDistance, 0.0), 4.0)));
+    _board[{0, 9 - scout}] = { { 'P', 'B' }, _player };
+    _board[{4, scout}] = { { 'P', 'B' }, _player };
+    _board[{4, 9 - scout}] = { { 'P', 'B' }, _player };
     _board[{0, 2}] = { { 'S', 'B' }, _player };
-    // rotate the board by 90deg - flag can be on any edge
-    auto n = std::uniform_int_distribution<int>(0, 3)(_rg);
-    for (auto i = 0; i < n; i++) rotateBoard();
+    // the flag can be in either back corner
+    if (std::uniform_int_distribution<int>(0, 1)(_rg)) mirrorBoard(false);
+    if (_player == 2) mirrorBoard(true);
 }
 
-void AutoPlayerAlgorithm::rotateBoard() {
+// flips the board over its middle, between the halves of the players or between their sides
+void AutoPlayerAlgorithm::mirrorBoard(bool rows) {
     GameBoard<Piece> oldBoard = _board;
     for (auto i = 0; i < _board.N; i++) {
         for (auto j = 0; j < _board.M; j++) {
-            _board[{i, j}] = oldBoard[{_board.N - 1 - j, i}];
+            _board[{i, j}] = rows ? oldBoard[{_board.N - 1 - i, j}] : oldBoard[{i, _board.M - 1 - j}];
         }
     }
 }
@@ -5,36 +5,46 @@
 #include <vector>
 #include <map>
 #include "PlayerAlgorithm.h"
+#include "PlayerAlgorithmV2.h"
 #include "GameContainers.h"
 #include "PiecePosition.h"
 #include "JokerChange.h"
 #include "FightInfo.h"
 #include "Board.h"
 #include "Move.h"
+#include "AutoParams.h"
 
 
-class AutoPlayerAlgorithm : public PlayerAlgorithm {
+class AutoPlayerAlgorithm : public PlayerAlgorithmV2 {
 public:
-    AutoPlayerAlgorithm();
+    AutoPlayerAlgorithm(); // with the parameters of $RPS_PARAMS, the defaults without it
+    explicit AutoPlayerAlgorithm(const AutoParams& params);
     void getInitialPositions(int player, std::vector<std::unique_ptr<PiecePosition>>& positions) override;
     void notifyOnInitialBoard(const Board& b, const std::vector<std::unique_ptr<FightInfo>>& fights) override;
     void notifyOnOpponentMove(const Move& move) override;
     void notifyFightResult(const FightInfo& fightInfo) override;
     std::unique_ptr<Move> getMove() override;
     std::unique_ptr<JokerChange> getJokerChange() override;
+    void playTurn(const TurnEvent* events, std::size_t numEvents, TurnReply& reply) override;
 private:
     struct Piece {
         char type = ' ';
         char jokerType = ' ';
+        bool moved = false; // of an opponent piece, since it was positioned
         friend std::ostream& operator<<(std::ostream& os, const Piece piece) { return os << piece.type; }
     };
-    std::unique_ptr<GamePoint> getPosToMoveFrom() const;
-    std::unique_ptr<GamePoint> getBestNeighbor(const Point& from) const;
+    int evaluate() const;
+    bool getTablebaseMove(std::unique_ptr<GamePoint>& from, std::unique_ptr<GamePoint>& to) const;
+    int flagDistance(const GamePoint& pos) const;
+    bool getBestMove(std::unique_ptr<GamePoint>& from, std::unique_ptr<GamePoint>& to) const;
+    double scoreMove(const GamePoint& from, const GamePoint& to, const std::vector<GamePoint>& opponents) const;
+    static int distance(const GamePoint& pos, const std::vector<GamePoint>& points);
+    static int fightOutcome(char ours, char theirs);
     std::vector<GamePoint> validPermutations(const Point& from) const;
-    bool hasValidMove(int x, int y) const;
     bool isMovable(const Piece& piece) const;
     void initBoard();
-    void rotateBoard();
+    void mirrorBoard(bool rows);
+    AutoParams _params;
     int _player;
     int _opponent;
     GameBoard<Piece> _board;
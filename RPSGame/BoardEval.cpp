@@ -0,0 +1,207 @@
+#include <cstring>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BOARD_EVAL_X86
+#endif
+#include "BoardEval.h"
+
+// Score = material + threats we make - threats we face - pieces next to our flag, where a
+// threat is a piece next to a piece of the type that beats it.
+constexpr int WEIGHTS[8] = { 40, 30, 40, 0, -40, -30, -40, -30 }; // material, by bit
+const int THREAT_WEIGHT = 12;
+const int EXPOSED_WEIGHT = 4; // a movable piece of ours next to an unknown piece
+const int FLAG_WEIGHT = 25;
+
+const int OFFSETS[8] = {
+    -BoardEval::STRIDE - 1, -BoardEval::STRIDE, -BoardEval::STRIDE + 1, -1, 1,
+    BoardEval::STRIDE - 1, BoardEval::STRIDE, BoardEval::STRIDE + 1 };
+
+// counts accumulated by each variant, combined the same way
+struct Counts {
+    int material = 0;
+    int threatened = 0; // our pieces next to a piece that beats them
+    int threatening = 0; // their pieces next to a piece of ours that beats them
+    int exposed = 0;
+};
+
+static int score(const BoardEval::Board& board, const Counts& counts) {
+    int score = counts.material;
+    score += THREAT_WEIGHT * (counts.threatening - counts.threatened) - EXPOSED_WEIGHT * counts.exposed;
+    if (board.flag >= 0) {
+        for (const auto offset : OFFSETS) score -= FLAG_WEIGHT * ((board[board.flag + offset] & BoardEval::Theirs) != 0);
+    }
+    return score;
+}
+
+void BoardEval::Board::clear() {
+    std::memset(bytes, 0, sizeof(bytes));
+    flag = -1;
+}
+
+static int evaluateScalar(const BoardEval::Board& board) {
+    using B = BoardEval;
+    Counts counts;
+    for (int square = 0; square < B::SQUARES; square++) {
+        const auto cell = board[square];
+        if (cell == 0) continue;
+        uint8_t adjacent = 0;
+        for (const auto offset : OFFSETS) adjacent |= board[square + offset];
+        for (int bit = 0; bit < 8; bit++) counts.material += ((cell >> bit) & 1) * WEIGHTS[bit];
+        counts.threatened += ((cell & B::OurR) && (adjacent & B::TheirP)) + ((cell & B::OurP) && (adjacent & B::TheirS))
+            + ((cell & B::OurS) && (adjacent & B::TheirR));
+        counts.threatening += ((cell & B::TheirR) && (adjacent & B::OurP)) + ((cell & B::TheirP) && (adjacent & B::OurS))
+            + ((cell & B::TheirS) && (adjacent & B::OurR));
+        counts.exposed += (cell & (B::OurR | B::OurP | B::OurS)) && (adjacent & B::TheirUnknown);
+    }
+    return score(board, counts);
+}
+
+#ifdef BOARD_EVAL_X86
+
+// The vector variants keep a count per byte lane in an accumulator per term, a square
+// matching a term subtracts its all-ones mask, and sum the lanes once at the end.
+
+// the squares of v having all of bits
+__attribute__((target("sse2"))) static inline __m128i has(__m128i v, uint8_t bits) {
+    const auto mask = _mm_set1_epi8(static_cast<char>(bits));
+    return _mm_cmpeq_epi8(_mm_and_si128(v, mask), mask);
+}
+
+__attribute__((target("sse2"))) static inline int sum(__m128i lanes) {
+    const auto sums = _mm_sad_epu8(lanes, _mm_setzero_si128());
+    return _mm_cvtsi128_si32(sums) + _mm_extract_epi16(sums, 4);
+}
+
+__attribute__((target("sse2"))) static int evaluateSse2(const BoardEval::Board& board) {
+    using B = BoardEval;
+    const auto squares = board.bytes + B::PADDING;
+    const auto zero = _mm_setzero_si128();
+    __m128i bits[8];
+    for (auto& lanes : bits) lanes = zero;
+    auto threatened = zero;
+    auto threatening = zero;
+    auto exposed = zero;
+    for (int square = 0; square < B::SQUARES; square += 16) {
+        const auto cells = _mm_loadu_si128(reinterpret_cast<const __m128i*>(squares + square));
+        auto adjacent = zero;
+        for (const auto offset : OFFSETS) {
+            adjacent = _mm_or_si128(adjacent, _mm_loadu_si128(reinterpret_cast<const __m128i*>(squares + square + offset)));
+        }
+#pragma GCC unroll 8
+        for (int bit = 0; bit < 8; bit++) bits[bit] = _mm_sub_epi8(bits[bit], has(cells, 1 << bit));
+        threatened = _mm_sub_epi8(threatened, _mm_and_si128(has(cells, B::OurR), has(adjacent, B::TheirP)));
+        threatened = _mm_sub_epi8(threatened, _mm_and_si128(has(cells, B::OurP), has(adjacent, B::TheirS)));
+        threatened = _mm_sub_epi8(threatened, _mm_and_si128(has(cells, B::OurS), has(adjacent, B::TheirR)));
+        threatening = _mm_sub_epi8(threatening, _mm_and_si128(has(cells, B::TheirR), has(adjacent, B::OurP)));
+        threatening = _mm_sub_epi8(threatening, _mm_and_si128(has(cells, B::TheirP), has(adjacent, B::OurS)));
+        threatening = _mm_sub_epi8(threatening, _mm_and_si128(has(cells, B::TheirS), has(adjacent, B::OurR)));
+        const auto unmovable = _mm_cmpeq_epi8(_mm_and_si128(cells, _mm_set1_epi8(B::OurR | B::OurP | B::OurS)), zero);
+        exposed = _mm_sub_epi8(exposed, _mm_andnot_si128(unmovable, has(adjacent, B::TheirUnknown)));
+    }
+    Counts counts;
+    for (int bit = 0; bit < 8; bit++) counts.material += sum(bits[bit]) * WEIGHTS[bit];
+    counts.threatened = sum(threatened);
+    counts.threatening = sum(threatening);
+    counts.exposed = sum(exposed);
+    return score(board, counts);
+}
+
+// the material of the 4 bits of a nibble of a square, of the side whose bits start at first
+constexpr uint8_t nibbleMaterial(int nibble, int first) {
+    int material = 0;
+    for (int bit = 0; bit < 4; bit++) {
+        if (nibble & (1 << bit)) material += WEIGHTS[first + bit] < 0 ? -WEIGHTS[first + bit] : WEIGHTS[first + bit];
+    }
+    return material;
+}
+
+#define NIBBLE_TABLE(first) \
+    nibbleMaterial(0, first), nibbleMaterial(1, first), nibbleMaterial(2, first), nibbleMaterial(3, first), \
+    nibbleMaterial(4, first), nibbleMaterial(5, first), nibbleMaterial(6, first), nibbleMaterial(7, first), \
+    nibbleMaterial(8, first), nibbleMaterial(9, first), nibbleMaterial(10, first), nibbleMaterial(11, first), \
+    nibbleMaterial(12, first), nibbleMaterial(13, first), nibbleMaterial(14, first), nibbleMaterial(15, first)
+
+// for vpshufb, which looks up each 128 bit half separately
+alignas(32) const uint8_t OUR_MATERIAL[32] = { NIBBLE_TABLE(0), NIBBLE_TABLE(0) };
+alignas(32) const uint8_t THEIR_MATERIAL[32] = { NIBBLE_TABLE(4), NIBBLE_TABLE(4) };
+
+__attribute__((target("avx2"))) static inline __m256i has(__m256i v, uint8_t bits) {
+    const auto mask = _mm256_set1_epi8(static_cast<char>(bits));
+    return _mm256_cmpeq_epi8(_mm256_and_si256(v, mask), mask);
+}
+
+__attribute__((target("avx2"))) static inline int sum(__m256i lanes) {
+    const auto sums = _mm256_sad_epu8(lanes, _mm256_setzero_si256());
+    const auto halves = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+    return _mm_cvtsi128_si32(halves) + _mm_extract_epi16(halves, 4);
+}
+
+__attribute__((target("avx2"))) static inline int sum64(__m256i lanes) {
+    const auto halves = _mm_add_epi64(_mm256_castsi256_si128(lanes), _mm256_extracti128_si256(lanes, 1));
+    return _mm_cvtsi128_si32(halves) + _mm_extract_epi16(halves, 4);
+}
+
+__attribute__((target("avx2"))) static int evaluateAvx2(const BoardEval::Board& board) {
+    using B = BoardEval;
+    const auto squares = board.bytes + B::PADDING;
+    const auto zero = _mm256_setzero_si256();
+    const auto ourMaterial = _mm256_load_si256(reinterpret_cast<const __m256i*>(OUR_MATERIAL));
+    const auto theirMaterial = _mm256_load_si256(reinterpret_cast<const __m256i*>(THEIR_MATERIAL));
+    const auto lowNibble = _mm256_set1_epi8(0x0f);
+    auto ours = zero; // material, summed into 64 bit lanes
+    auto theirs = zero;
+    auto threatened = zero;
+    auto threatening = zero;
+    auto exposed = zero;
+    for (int square = 0; square < B::SQUARES; square += 32) {
+        const auto cells = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(squares + square));
+        auto adjacent = zero;
+        for (const auto offset : OFFSETS) {
+            adjacent = _mm256_or_si256(adjacent, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(squares + square + offset)));
+        }
+        const auto ourNibbles = _mm256_and_si256(cells, lowNibble);
+        const auto theirNibbles = _mm256_and_si256(_mm256_srli_epi16(cells, 4), lowNibble);
+        ours = _mm256_add_epi64(ours, _mm256_sad_epu8(_mm256_shuffle_epi8(ourMaterial, ourNibbles), zero));
+        theirs = _mm256_add_epi64(theirs, _mm256_sad_epu8(_mm256_shuffle_epi8(theirMaterial, theirNibbles), zero));
+        threatened = _mm256_sub_epi8(threatened, _mm256_and_si256(has(cells, B::OurR), has(adjacent, B::TheirP)));
+        threatened = _mm256_sub_epi8(threatened, _mm256_and_si256(has(cells, B::OurP), has(adjacent, B::TheirS)));
+        threatened = _mm256_sub_epi8(threatened, _mm256_and_si256(has(cells, B::OurS), has(adjacent, B::TheirR)));
+        threatening = _mm256_sub_epi8(threatening, _mm256_and_si256(has(cells, B::TheirR), has(adjacent, B::OurP)));
+        threatening = _mm256_sub_epi8(threatening, _mm256_and_si256(has(cells, B::TheirP), has(adjacent, B::OurS)));
+        threatening = _mm256_sub_epi8(threatening, _mm256_and_si256(has(cells, B::TheirS), has(adjacent, B::OurR)));
+        const auto unmovable = _mm256_cmpeq_epi8(_mm256_and_si256(cells, _mm256_set1_epi8(B::OurR | B::OurP | B::OurS)), zero);
+        exposed = _mm256_sub_epi8(exposed, _mm256_andnot_si256(unmovable, has(adjacent, B::TheirUnknown)));
+    }
+    Counts counts;
+    counts.material = sum64(ours) - sum64(theirs);
+    counts.threatened = sum(threatened);
+    counts.threatening = sum(threatening);
+    counts.exposed = sum(exposed);
+    return score(board, counts);
+}
+
+#endif
+
+BoardEval::Variant BoardEval::best() {
+#ifdef BOARD_EVAL_X86
+    static const Variant variant = __builtin_cpu_supports("avx2") ? Variant::Avx2 :
+        (__builtin_cpu_supports("sse2") ? Variant::Sse2 : Variant::Scalar);
+    return variant;
+#else
+    return Variant::Scalar;
+#endif
+}
+
+int BoardEval::evaluate(const Board& board) {
+    return evaluate(board, best());
+}
+
+int BoardEval::evaluate(const Board& board, Variant variant) {
+    switch (variant) {
+#ifdef BOARD_EVAL_X86
+    case Variant::Avx2: return evaluateAvx2(board);
+    case Variant::Sse2: return evaluateSse2(board);
+#endif
+    default: return evaluateScalar(board);
+    }
+}
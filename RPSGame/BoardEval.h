@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+
+
+// Static evaluation of a board from one player's side, over a byte per square. The board has a
+// one square empty border, so the neighbors of a square are at fixed offsets and the squares
+// adjacent to each piece type are the OR of 8 shifted copies of the board, which the vector
+// variants compute 16 or 32 squares at a time. All variants return the same score.
+class BoardEval {
+public:
+    // a bit per piece type and side, our unmoved pieces may be flags or bombs and theirs anything
+    enum Bits : uint8_t {
+        OurR = 0x01,
+        OurP = 0x02,
+        OurS = 0x04,
+        OurOther = 0x08, // flag, bomb or a joker that can't move
+        TheirR = 0x10,
+        TheirP = 0x20,
+        TheirS = 0x40,
+        TheirUnknown = 0x80, // not revealed by a fight
+        Ours = 0x0f,
+        Theirs = 0xf0,
+    };
+    static const int STRIDE = 12; // a row of 10 squares and the border on both sides
+    static const int PADDING = 16; // before and after the squares, for the shifted loads
+    static const int SQUARES = 160; // 12 rows, rounded up to whole AVX2 vectors
+    struct Board {
+        alignas(32) uint8_t bytes[PADDING + SQUARES + 32];
+        int flag = -1; // square of our flag, -1 if unknown
+        Board() { clear(); }
+        void clear();
+        // x and y are the 1-based coordinates of the board
+        static int square(int x, int y) { return x * STRIDE + y; }
+        uint8_t& operator[](int square) { return bytes[PADDING + square]; }
+        uint8_t operator[](int square) const { return bytes[PADDING + square]; }
+    };
+    enum class Variant { Scalar, Sse2, Avx2 };
+    static Variant best(); // the widest variant this cpu runs
+    static int evaluate(const Board& board); // with the best variant
+    static int evaluate(const Board& board, Variant variant);
+};
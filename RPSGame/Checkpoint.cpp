@@ -0,0 +1,87 @@
+#include <fstream>
+#include <cstdint>
+#include <cstdio>
+#include "Checkpoint.h"
+
+// File layout, integers are little endian:
+//   "RPSCKPT1"
+//   u32 number of scores, then per score: u16 id length, id, u32 score
+//   u32 number of games, then per game: u16 id1 length, id1, u16 id2 length, id2, u8 flag
+
+const std::string CHECKPOINT_MAGIC = "RPSCKPT1";
+
+template<class T>
+static void writeInt(std::ostream& os, T value) {
+    for (unsigned int i = 0; i < sizeof(T); i++) os.put(static_cast<char>((value >> (8 * i)) & 0xff));
+}
+
+template<class T>
+static bool readInt(std::istream& is, T& value) {
+    value = 0;
+    for (unsigned int i = 0; i < sizeof(T); i++) {
+        const auto ch = is.get();
+        if (ch == EOF) return false;
+        value |= static_cast<T>(static_cast<unsigned char>(ch)) << (8 * i);
+    }
+    return true;
+}
+
+static void writeString(std::ostream& os, const std::string& str) {
+    writeInt<uint16_t>(os, str.size());
+    os.write(str.data(), str.size());
+}
+
+static bool readString(std::istream& is, std::string& str) {
+    uint16_t length;
+    if (!readInt(is, length)) return false;
+    str.resize(length);
+    return static_cast<bool>(is.read(&str[0], length));
+}
+
+bool Checkpoint::save(const std::string& fname) const {
+    // written aside and renamed so a crash mid-write keeps the previous checkpoint
+    const auto tmpName = fname + ".tmp";
+    {
+        std::ofstream os(tmpName, std::ios::binary | std::ios::trunc);
+        os.write(CHECKPOINT_MAGIC.data(), CHECKPOINT_MAGIC.size());
+        writeInt<uint32_t>(os, scores.size());
+        for (const auto& score : scores) {
+            writeString(os, score.first);
+            writeInt<uint32_t>(os, score.second);
+        }
+        writeInt<uint32_t>(os, games.size());
+        for (const auto& game : games) {
+            writeString(os, std::get<0>(game));
+            writeString(os, std::get<1>(game));
+            writeInt<uint8_t>(os, std::get<2>(game));
+        }
+        if (!os.flush()) return false;
+    }
+    return std::rename(tmpName.c_str(), fname.c_str()) == 0;
+}
+
+bool Checkpoint::load(const std::string& fname) {
+    std::ifstream is(fname, std::ios::binary);
+    std::string magic(CHECKPOINT_MAGIC.size(), ' ');
+    if (!is.read(&magic[0], magic.size()) || magic != CHECKPOINT_MAGIC) return false;
+    scores.clear();
+    games.clear();
+    uint32_t numScores;
+    if (!readInt(is, numScores)) return false;
+    for (uint32_t i = 0; i < numScores; i++) {
+        std::string id;
+        uint32_t score;
+        if (!readString(is, id) || !readInt(is, score)) return false;
+        scores[id] = score;
+    }
+    uint32_t numGames;
+    if (!readInt(is, numGames)) return false;
+    for (uint32_t i = 0; i < numGames; i++) {
+        std::string id1;
+        std::string id2;
+        uint8_t flag;
+        if (!readString(is, id1) || !readString(is, id2) || !readInt(is, flag)) return false;
+        games.emplace_back(id1, id2, flag != 0);
+    }
+    return true;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <tuple>
+#include <map>
+
+
+// tournament state that survives a restart: accumulated scores and the games not played yet
+struct Checkpoint {
+    using Match = std::tuple<std::string, std::string, bool>;
+    std::map<std::string, unsigned int> scores;
+    std::vector<Match> games;
+    bool save(const std::string& fname) const;
+    bool load(const std::string& fname);
+};
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <memory>
+#include <utility>
+#include <vector>
+#include "PlayerAlgorithmV2.h"
+
+
+// What a DecoratedPlayer adds around the calls of the player it wraps. A policy derives from
+// this, defines a Scope constructed from the policy that is alive during every call (the
+// destructor of the player included) and may override the hooks, which see the results.
+struct PlayerPolicy {
+    void afterPositions(std::vector<unique_ptr<PiecePosition>>&) {}
+    void afterMove(unique_ptr<Move>&) {}
+    void afterTurn(TurnReply&) {}
+};
+
+// Forwards every call of a player within a Policy::Scope, see decoratePlayer.
+template<class Policy, class Base = PlayerAlgorithm>
+class DecoratedPlayer : public Base {
+public:
+    using Scope = typename Policy::Scope;
+    DecoratedPlayer(std::unique_ptr<PlayerAlgorithm> algo, Policy policy) :
+        _algo(std::move(algo)), _policy(std::move(policy)) {}
+    ~DecoratedPlayer() {
+        Scope scope(_policy);
+        _algo.reset();
+    }
+    void getInitialPositions(int player, std::vector<unique_ptr<PiecePosition>>& vectorToFill) override {
+        {
+            Scope scope(_policy);
+            _algo->getInitialPositions(player, vectorToFill);
+        }
+        _policy.afterPositions(vectorToFill);
+    }
+    void notifyOnInitialBoard(const Board& b, const std::vector<unique_ptr<FightInfo>>& fights) override {
+        Scope scope(_policy);
+        _algo->notifyOnInitialBoard(b, fights);
+    }
+    void notifyOnOpponentMove(const Move& move) override {
+        Scope scope(_policy);
+        _algo->notifyOnOpponentMove(move);
+    }
+    void notifyFightResult(const FightInfo& fightInfo) override {
+        Scope scope(_policy);
+        _algo->notifyFightResult(fightInfo);
+    }
+    unique_ptr<Move> getMove() override {
+        unique_ptr<Move> move;
+        {
+            Scope scope(_policy);
+            move = _algo->getMove();
+        }
+        _policy.afterMove(move);
+        return move;
+    }
+    unique_ptr<JokerChange> getJokerChange() override {
+        Scope scope(_policy);
+        return _algo->getJokerChange();
+    }
+protected:
+    std::unique_ptr<PlayerAlgorithm> _algo;
+    Policy _policy;
+};
+
+// keeps a PlayerAlgorithmV2 visible to the referee's dynamic_cast
+template<class Policy>
+class DecoratedPlayerV2 : public DecoratedPlayer<Policy, PlayerAlgorithmV2> {
+public:
+    DecoratedPlayerV2(std::unique_ptr<PlayerAlgorithm> algo, Policy policy) :
+        DecoratedPlayer<Policy, PlayerAlgorithmV2>(std::move(algo), std::move(policy)),
+        _algoV2(dynamic_cast<PlayerAlgorithmV2*>(this->_algo.get())) {}
+    void playTurn(const TurnEvent* events, std::size_t numEvents, TurnReply& reply) override {
+        {
+            typename Policy::Scope scope(this->_policy);
+            _algoV2->playTurn(events, numEvents, reply);
+        }
+        this->_policy.afterTurn(reply);
+    }
+private:
+    PlayerAlgorithmV2* _algoV2;
+};
+
+template<class Policy>
+std::unique_ptr<PlayerAlgorithm> decoratePlayer(std::unique_ptr<PlayerAlgorithm> algo, Policy policy) {
+    if (dynamic_cast<PlayerAlgorithmV2*>(algo.get())) {
+        return std::make_unique<DecoratedPlayerV2<Policy>>(std::move(algo), std::move(policy));
+    }
+    return std::make_unique<DecoratedPlayer<Policy>>(std::move(algo), std::move(policy));
+}
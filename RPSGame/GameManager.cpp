@@ -1,4 +1,3 @@
-#include <fstream>
 #include <vector>
 #include "GameManager.h"
 #include "Piece.h"
@@ -6,43 +5,63 @@
 #include "Move.h"
 #include "JokerChange.h"
 #include "PiecePosition.h"
+#include "Log.h"
 
-std::fstream nullstream;
-#define DEBUG(x) do { nullstream << "GameManager::" << __func__ << "()\t" << x << std::endl; } while (0)
+#define DEBUG(x) LOG_DEBUG("GameManager::" << __func__ << "()\t" << x)
 
-int GameManager::playRound(std::shared_ptr<PlayerAlgorithm> algo1, std::shared_ptr<PlayerAlgorithm> algo2) {
+GameManager::GameResult GameManager::playRound(std::shared_ptr<PlayerAlgorithm> algo1, std::shared_ptr<PlayerAlgorithm> algo2) {
+    start(algo1, algo2);
+    while (step()) {}
+    return output();
+}
+
+void GameManager::start(std::shared_ptr<PlayerAlgorithm> algo1, std::shared_ptr<PlayerAlgorithm> algo2) {
     // init
     _players[0] = std::make_unique<Player>(1, algo1);
     _players[1] = std::make_unique<Player>(2, algo2);
-    _board.clear();
-    _numFights = 0;
+    _state.clear();
+    _numTurns = 0;
+    _current = 0;
+    _done = false;
     // positioning
     std::vector<std::unique_ptr<FightInfo>> fights;
     position(0, fights);
     position(1, fights);
-    if (!isValid(_players[0]) || !isValid(_players[1])) return output();
-    _players[0]->algo->notifyOnInitialBoard(_board, fights);
-    _players[1]->algo->notifyOnInitialBoard(_board, fights);
-    // moves
-    auto i = 0;
-    while (_numFights < FIGHTS_THRESHOLD) {
-        if (!isValid(_players[0]) || !isValid(_players[1])) break;
-        doMove(i);
-        if (!isValid(_players[0]) || !isValid(_players[1])) break;
-        changeJoker(i);
-        i = 1 - i; // switch player
+    if (!isValid(_players[0]) || !isValid(_players[1])) {
+        _done = true;
+        return;
     }
-    return output();
+    _players[0]->algo->notifyOnInitialBoard(_state.board(), fights);
+    _players[1]->algo->notifyOnInitialBoard(_state.board(), fights);
+}
+
+bool GameManager::step() {
+    if (_done) return false;
+    if (_state.numFights() >= FIGHTS_THRESHOLD || !isValid(_players[0]) || !isValid(_players[1])) {
+        _done = true;
+        return false;
+    }
+    _numTurns++;
+    doMove(_current);
+    if (!isValid(_players[0]) || !isValid(_players[1])) {
+        _done = true;
+        return false;
+    }
+    changeJoker(_current);
+    _current = 1 - _current; // switch player
+    return true;
 }
 
 void GameManager::position(int i, std::vector<std::unique_ptr<FightInfo>>& fights) {
     auto& player = _players[i];
     GameBoard<Piece> tmpBoard;
+    GameState::Side side;
     std::vector<std::unique_ptr<PiecePosition>> positions;
     player->algo->getInitialPositions(player->index, positions);
     // populate tmpBoard & player piece map
     for (const auto& piecePos : positions) {
         if (!isValid(piecePos, tmpBoard)) {
+            DEBUG("player " << player->index << " invalid piece position");
             player->status = PlayerStatus::InvalidPos;
             return;
         }
@@ -50,119 +69,154 @@ void GameManager::position(int i, std::vector<std::unique_ptr<FightInfo>>& fight
         auto type = piecePos->getPiece();
         auto jokerType = piecePos->getJokerRep();
         tmpBoard[pos] = { Piece(player->index, type, jokerType), player->index };
-        player->numPieces[type]++;
-        if (tmpBoard[pos].piece.getType() == 'F') player->numFlags++;
-        if (tmpBoard[pos].piece.canMove()) player->numMovable++;
+        GameState::add(side, tmpBoard[pos].piece);
     }
-    if (!isValid(player)) {
+    if (!GameState::isValid(side)) {
+        DEBUG("player " << player->index << " invalid positioning");
         player->status = PlayerStatus::InvalidPos;
         return;
     }
     // merge tmpBoard and main board
-    for (unsigned int i = 1; i <= _board.N; i++) {
-        for (unsigned int j = 1; j <= _board.N; j++) {
+    for (unsigned int i = 1; i <= tmpBoard.N; i++) {
+        for (unsigned int j = 1; j <= tmpBoard.N; j++) {
             GamePoint pos(i, j);
-            auto fightInfo = fight(pos, tmpBoard[pos].piece);
-            if (fightInfo) fights.push_back(std::move(fightInfo));
-            }
+            const auto& piece = tmpBoard[pos].piece;
+            if (piece.getPlayer() == 0) continue;
+            const auto opponentPiece = _state.board()[pos].piece;
+            const auto winner = _state.place(pos, piece);
+            if (winner == GameState::NO_FIGHT) continue;
+            updateStatus(piece, winner);
+            updateStatus(opponentPiece, winner);
+            fights.push_back(std::make_unique<GameFightInfo>(fightInfo(pos, piece, opponentPiece, winner)));
         }
     }
+}
 
 void GameManager::doMove(int i) {
-    const auto move = _players[i]->algo->getMove();
+    auto& player = _players[i];
+    std::unique_ptr<Move> classicMove;
+    GameMove v2Move(0, 0, 0, 0);
+    const Move* move;
+    if (player->algoV2) {
+        player->reply = TurnReply();
+        player->algoV2->playTurn(player->events.data(), player->events.size(), player->reply);
+        player->events.clear();
+        const auto& reply = player->reply;
+        v2Move = GameMove(reply.fromX, reply.fromY, reply.toX, reply.toY);
+        move = &v2Move;
+    } else {
+        classicMove = player->algo->getMove();
+        move = classicMove.get();
+    }
     if (!isValid(move, i)) {
-        _players[i]->status = PlayerStatus::InvalidMove;
+        DEBUG("player " << i + 1 << " invalid move");
+        player->status = PlayerStatus::InvalidMove;
         return;
     }
-    _players[1 - i]->algo->notifyOnOpponentMove(*move);
-    auto fightInfo = fight(move->getTo(), _board[move->getFrom()].piece);
-    if (fightInfo) {
-        _players[0]->algo->notifyFightResult(*fightInfo);
-        _players[1]->algo->notifyFightResult(*fightInfo);
-        _numFights = 0;
-    } else {
-        _numFights++;
-    }
-    _board[move->getFrom()] = { Piece(), 0 };
+    notifyOnOpponentMove(1 - i, *move);
+    const auto& from = move->getFrom();
+    const auto& to = move->getTo();
+    const auto piece1 = _state.board()[from].piece;
+    const auto piece2 = _state.board()[to].piece;
+    const auto winner = _state.makeMove(from, to);
+    _state.discardUndo(); // the referee never takes a move back
+    if (winner == GameState::NO_FIGHT) return;
+    updateStatus(piece1, winner);
+    updateStatus(piece2, winner);
+    const auto info = fightInfo(to, piece1, piece2, winner);
+    notifyFightResult(0, info);
+    notifyFightResult(1, info);
 }
 
 void GameManager::changeJoker(int i) {
     auto& player = _players[i];
-    const auto jokerChange = player->algo->getJokerChange();
+    std::unique_ptr<JokerChange> classicChange;
+    const JokerChange* jokerChange;
+    GameJokerChange v2Change(GamePoint(player->reply.jokerX, player->reply.jokerY), player->reply.jokerRep);
+    if (player->algoV2) {
+        jokerChange = player->reply.jokerRep ? &v2Change : nullptr;
+    } else {
+        classicChange = player->algo->getJokerChange();
+        jokerChange = classicChange.get();
+    }
     if (!jokerChange) return;
     if (!isValid(jokerChange, i)) {
+        DEBUG("player " << i + 1 << " invalid joker change");
         player->status = PlayerStatus::InvalidMove;
         return;
     }
-    auto& piece = _board[jokerChange->getJokerChangePosition()].piece;
-    piece.setJokerType(jokerChange->getJokerNewRep());
+    _state.changeJoker(jokerChange->getJokerChangePosition(), jokerChange->getJokerNewRep());
+    _state.discardUndo();
 }
 
-int GameManager::output() {
+void GameManager::notifyOnOpponentMove(int i, const Move& move) {
+    auto& player = _players[i];
+    if (!player->algoV2) return player->algo->notifyOnOpponentMove(move);
+    const auto& from = move.getFrom();
+    const auto& to = move.getTo();
+    player->events.push_back({ TurnEvent::OpponentMove, 0, 0, 0,
+        int8_t(from.getX()), int8_t(from.getY()), int8_t(to.getX()), int8_t(to.getY()) });
+}
+
+void GameManager::notifyFightResult(int i, const FightInfo& fightInfo) {
+    auto& player = _players[i];
+    if (!player->algoV2) return player->algo->notifyFightResult(fightInfo);
+    const auto& pos = fightInfo.getPosition();
+    player->events.push_back({ TurnEvent::Fight, fightInfo.getPiece(1), fightInfo.getPiece(2),
+        uint8_t(fightInfo.getWinner()), 0, 0, int8_t(pos.getX()), int8_t(pos.getY()) });
+}
+
+GameManager::GameResult GameManager::output() const {
+    GameResult result;
     auto is1Playing = _players[0]->status == PlayerStatus::Playing;
     auto is2Playing = _players[1]->status == PlayerStatus::Playing;
-    return (is1Playing == is2Playing) ? 0 : (is1Playing ? 1 : 2);
-}
-
-std::unique_ptr<FightInfo> GameManager::fight(const Point& pos, const Piece& piece1) {
-    auto piece2 = _board[pos].piece;
-    auto killPiece1 = piece2.canKill(piece1);
-    auto killPiece2 = piece1.canKill(piece2);
-    if (killPiece1 && piece1.getPlayer() != 0) kill(piece1);
-    if (killPiece2 && piece2.getPlayer() != 0) kill(piece2);
-    auto piece = killPiece1 && killPiece2 ? Piece() : (killPiece1 ? piece2 : piece1);
-    _board[pos] = { piece, piece.getPlayer() };
-    if (piece1.getPlayer() == 0 || piece2.getPlayer() == 0) return nullptr;
-    auto winner = (killPiece1 && killPiece2) ? 0 : (killPiece1 ? piece2.getPlayer() : piece1.getPlayer());
+    result.winner = (is1Playing == is2Playing) ? 0 : (is1Playing ? 1 : 2);
+    result.status[0] = _players[0]->status;
+    result.status[1] = _players[1]->status;
+    result.turns = _numTurns;
+    result.fightsThreshold = _state.numFights() >= FIGHTS_THRESHOLD;
+    return result;
+}
+
+const char* GameManager::GameResult::endReason() const {
+    // the status of the (first) player who lost
+    for (const auto playerStatus : status) {
+        switch (playerStatus) {
+        case PlayerStatus::Playing: break;
+        case PlayerStatus::InvalidPos: return "invalid_position";
+        case PlayerStatus::InvalidMove: return "invalid_move";
+        case PlayerStatus::NoFlags: return "no_flags";
+        case PlayerStatus::CantMove: return "cant_move";
+        }
+    }
+    // both still playing, a player without flags or movable pieces after positioning
+    // or with too many pieces ends the game in a tie as well
+    return fightsThreshold ? "fights_threshold" : "invalid_pieces";
+}
+
+// piece1 moved onto piece2 at pos
+GameFightInfo GameManager::fightInfo(const Point& pos, const Piece& piece1, const Piece& piece2, int winner) const {
     auto ch1 = (piece1.getPlayer() == 1 ? piece1 : piece2).getUnderlyingType();
     auto ch2 = (piece1.getPlayer() == 2 ? piece1 : piece2).getUnderlyingType();
-    return std::make_unique<GameFightInfo>((const GamePoint&)pos, ch1, ch2, winner);
+    return GameFightInfo(GamePoint(pos.getX(), pos.getY()), ch1, ch2, winner);
 }
 
-void GameManager::kill(const Piece& piece) {
+// after a fight won by winner, the player of piece lost if it was their last flag or movable piece
+void GameManager::updateStatus(const Piece& piece, int winner) {
+    if (winner == piece.getPlayer()) return;
     auto& player = _players[piece.getPlayer() - 1];
-    player->numPieces[piece.getType()]--;
-    if (piece.getType() == 'F') {
-        player->numFlags--;
-        if (player->numFlags == 0) player->status = PlayerStatus::NoFlags;
-    }
-    if (piece.canMove()) {
-        player->numMovable--;
-        if (player->numMovable == 0) player->status = PlayerStatus::CantMove;
-    }
+    const auto& side = _state.side(piece.getPlayer());
+    if (piece.getType() == 'F' && side.numFlags == 0) player->status = PlayerStatus::NoFlags;
+    if (piece.canMove() && side.numMovable == 0) player->status = PlayerStatus::CantMove;
 }
 
-bool GameManager::isValid(const std::unique_ptr<Move>& move, int i) const {
+bool GameManager::isValid(const Move* move, int i) const {
     if (!move) return false;
-    const auto& from = move->getFrom();
-    const auto& to = move->getTo();
-    // check that points on board
-    if (!_board.isValid(to)) return false;
-    if (!_board.isValid(from)) return false;
-    // check  that points are next to each other
-    auto horizontal = std::abs(from.getX() - to.getX());
-    auto vertical = std::abs(from.getY() - to.getY());
-    if (horizontal > 1 || vertical > 1) return false;
-    if (horizontal == 0 && vertical == 0) return false;
-    // check that that piece is the player's piece and that it can move
-    if (_board[from].player != i + 1) return false;
-    if (!_board[from].piece.canMove()) return false;
-    // check that the destination doesn't contain a player's piece
-    if (_board[to].player == i + 1) return false;
-    return true;
+    return _state.isValidMove(move->getFrom(), move->getTo(), i + 1);
 }
 
-bool GameManager::isValid(const std::unique_ptr<JokerChange>& jokerChange, int i) const {
-    const auto rep = jokerChange->getJokerNewRep();
-    const auto& pos = jokerChange->getJokerChangePosition();
-    // check that point on board
-    if (!_board.isValid(pos)) return false;
-    // check that rep is valid
-    if (!Piece::isValid(rep)) return false;
-    // check that that piece is the player's piece and that it's a Joker
-    if (_board[pos].player != i + 1) return false;
-    if (_board[pos].piece.getType() != 'J') return false;
-    return true;
+bool GameManager::isValid(const JokerChange* jokerChange, int i) const {
+    return _state.isValidJokerChange(jokerChange->getJokerChangePosition(), jokerChange->getJokerNewRep(), i + 1);
 }
 
 bool GameManager::isValid(const std::unique_ptr<PiecePosition>& piecePos, const GameBoard<Piece>& board) const {
@@ -178,11 +232,5 @@ bool GameManager::isValid(const std::unique_ptr<PiecePosition>& piecePos, const
 bool GameManager::isValid(std::unique_ptr<Player>& player) const {
     // check that status is 'playing'
     if (player->status != PlayerStatus::Playing) return false;
-    // check that has plags and can move
-    if (player->numFlags == 0 || player->numMovable == 0) return false;
-    // check didn't exceed pieces capacity
-    for (const auto& type : player->numPieces) {
-        if (type.second > Piece::maxCapacity.at(type.first)) return false;
-    }
-    return true;
-}
\ No newline at end of file
+    return GameState::isValid(_state.side(player->index));
+}
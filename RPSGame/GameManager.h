@@ -2,17 +2,18 @@
 
 #include <memory>
 #include <map>
+#include <type_traits>
 #include "GameContainers.h"
 #include "PlayerAlgorithm.h"
+#include "PlayerAlgorithmV2.h"
 #include "Piece.h"
 #include "FightInfo.h"
 #include "Board.h"
+#include "GameState.h"
 
 
 class GameManager {
 public:
-    int playRound(std::shared_ptr<PlayerAlgorithm> algo1, std::shared_ptr<PlayerAlgorithm> algo2);
-private:
     enum class PlayerStatus {
         Playing,
         InvalidPos,
@@ -20,32 +21,52 @@ private:
         NoFlags,
         CantMove,
     };
+    struct GameResult {
+        int winner; // 1 or 2, 0 for a tie
+        PlayerStatus status[2];
+        unsigned int turns;
+        bool fightsThreshold; // ended by FIGHTS_THRESHOLD moves without a fight
+        const char* endReason() const;
+    };
+    GameResult playRound(std::shared_ptr<PlayerAlgorithm> algo1, std::shared_ptr<PlayerAlgorithm> algo2);
+    // the same game one turn at a time, so many games can be interleaved on one thread
+    void start(std::shared_ptr<PlayerAlgorithm> algo1, std::shared_ptr<PlayerAlgorithm> algo2);
+    bool step(); // plays the next turn, false once the game is over
+    bool done() const { return _done; }
+    int nextPlayer() const { return _current + 1; }
+    GameResult result() const { return output(); }
+private:
     struct Player {
         Player(int index, std::shared_ptr<PlayerAlgorithm> algo) :
             algo(algo),
             status(PlayerStatus::Playing),
-            numFlags(0),
-            numMovable(0),
-            index(index) {}
+            index(index),
+            algoV2(dynamic_cast<PlayerAlgorithmV2*>(algo.get())) {}
         std::shared_ptr<PlayerAlgorithm> algo;
         PlayerStatus status = PlayerStatus::Playing;
-        std::map<char, unsigned int> numPieces;
-        unsigned int numFlags;
-        unsigned int numMovable;
         int index;
+        PlayerAlgorithmV2* algoV2; // nullptr for classic players
+        std::vector<TurnEvent> events; // for the next playTurn of a v2 player
+        TurnReply reply;
     };
     void position(int i, std::vector<std::unique_ptr<FightInfo>>& fights);
     void doMove(int i);
     void changeJoker(int i);
-    int output();
-    std::unique_ptr<FightInfo> fight(const Point& pos, const Piece& piece1);
-    void kill(const Piece& piece);
-    bool isValid(const std::unique_ptr<Move>& move, int i) const;
-    bool isValid(const std::unique_ptr<JokerChange>& jokerChange, int i) const;
+    void notifyOnOpponentMove(int i, const Move& move);
+    void notifyFightResult(int i, const FightInfo& fightInfo);
+    GameResult output() const;
+    GameFightInfo fightInfo(const Point& pos, const Piece& piece1, const Piece& piece2, int winner) const;
+    void updateStatus(const Piece& piece, int winner);
+    bool isValid(const Move* move, int i) const;
+    bool isValid(const JokerChange* jokerChange, int i) const;
     bool isValid(const std::unique_ptr<PiecePosition>& piecePos, const GameBoard<Piece>& board) const;
     bool isValid(std::unique_ptr<Player>& player) const;
     std::unique_ptr<Player> _players[2];
-    GameBoard<Piece> _board;
-    unsigned int _numFights;
+    GameState _state;
+    unsigned int _numTurns;
+    int _current; // index of the player to move
+    bool _done;
     const unsigned int FIGHTS_THRESHOLD = 100;
-};
\ No newline at end of file
+};
+
+static_assert(std::is_trivially_copyable<GameManager::GameResult>::value, "results are copied between threads");
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include <cstring>
+#include <cstdlib>
+#include "GameState.h"
+
+const char GameState::TYPES[6] = { 'F', 'R', 'P', 'S', 'B', 'J' };
+
+void GameState::clear() {
+    _board.clear();
+    _sides[0] = Side();
+    _sides[1] = Side();
+    _numFights = 0;
+    _undo.clear();
+}
+
+int GameState::place(const Point& pos, const Piece& piece) {
+    add(_sides[piece.getPlayer() - 1], piece);
+    bool killed[2];
+    return fight(pos, piece, killed);
+}
+
+int GameState::makeMove(const Point& from, const Point& to) {
+    Change change{ _board[from], _board[to], from.getX(), from.getY(), to.getX(), to.getY(), _numFights, false, { false, false } };
+    const auto winner = fight(to, change.from.piece, change.killed);
+    _board[from] = { Piece(), 0 };
+    _numFights = winner == NO_FIGHT ? _numFights + 1 : 0;
+    _undo.push_back(change);
+    return winner;
+}
+
+// as before, a joker is counted by its type when it's placed and when it dies, not when it changes
+void GameState::changeJoker(const Point& pos, char rep) {
+    auto& entry = _board[pos];
+    _undo.push_back({ entry, entry, pos.getX(), pos.getY(), pos.getX(), pos.getY(), _numFights, true, { false, false } });
+    entry.piece.setJokerType(rep);
+}
+
+void GameState::unmakeMove() {
+    const auto change = _undo.back();
+    _undo.pop_back();
+    const GamePoint from(change.fromX, change.fromY);
+    const GamePoint to(change.toX, change.toY);
+    if (change.isJoker) {
+        _board[from] = change.from;
+        return;
+    }
+    if (change.killed[0]) add(_sides[change.from.player - 1], change.from.piece);
+    if (change.killed[1]) add(_sides[change.to.player - 1], change.to.piece);
+    _board[from] = change.from;
+    _board[to] = change.to;
+    _numFights = change.numFights;
+}
+
+// piece1 moves onto pos, killed is set for piece1 and for the piece that was there
+int GameState::fight(const Point& pos, const Piece& piece1, bool killed[2]) {
+    const auto piece2 = _board[pos].piece;
+    const auto killPiece1 = piece2.canKill(piece1);
+    const auto killPiece2 = piece1.canKill(piece2);
+    killed[0] = killPiece1 && piece1.getPlayer() != 0;
+    killed[1] = killPiece2 && piece2.getPlayer() != 0;
+    if (killed[0]) remove(piece1);
+    if (killed[1]) remove(piece2);
+    const auto piece = killPiece1 && killPiece2 ? Piece() : (killPiece1 ? piece2 : piece1);
+    _board[pos] = { piece, piece.getPlayer() };
+    if (piece1.getPlayer() == 0 || piece2.getPlayer() == 0) return NO_FIGHT;
+    return (killPiece1 && killPiece2) ? 0 : (killPiece1 ? piece2.getPlayer() : piece1.getPlayer());
+}
+
+void GameState::add(Side& side, const Piece& piece) {
+    side.numPieces[typeIndex(piece.getType())]++;
+    if (piece.getType() == 'F') side.numFlags++;
+    if (piece.canMove()) side.numMovable++;
+}
+
+void GameState::remove(const Piece& piece) {
+    auto& side = _sides[piece.getPlayer() - 1];
+    side.numPieces[typeIndex(piece.getType())]--;
+    if (piece.getType() == 'F') side.numFlags--;
+    if (piece.canMove()) side.numMovable--;
+}
+
+int GameState::typeIndex(char type) {
+    const auto found = static_cast<const char*>(std::memchr(TYPES, type, sizeof(TYPES)));
+    return found ? static_cast<int>(found - TYPES) : -1;
+}
+
+bool GameState::isValidMove(const Point& from, const Point& to, int player) const {
+    // check that points on board
+    if (!_board.isValid(to)) return false;
+    if (!_board.isValid(from)) return false;
+    // check  that points are next to each other
+    auto horizontal = std::abs(from.getX() - to.getX());
+    auto vertical = std::abs(from.getY() - to.getY());
+    if (horizontal > 1 || vertical > 1) return false;
+    if (horizontal == 0 && vertical == 0) return false;
+    // check that that piece is the player's piece and that it can move
+    if (_board[from].player != player) return false;
+    if (!_board[from].piece.canMove()) return false;
+    // check that the destination doesn't contain a player's piece
+    if (_board[to].player == player) return false;
+    return true;
+}
+
+bool GameState::isValidJokerChange(const Point& pos, char rep, int player) const {
+    // check that point on board
+    if (!_board.isValid(pos)) return false;
+    // check that rep is valid
+    if (!Piece::isValid(rep)) return false;
+    // check that that piece is the player's piece and that it's a Joker
+    if (_board[pos].player != player) return false;
+    if (_board[pos].piece.getType() != 'J') return false;
+    return true;
+}
+
+bool GameState::isValid(const Side& side) {
+    // check that has plags and can move
+    if (side.numFlags == 0 || side.numMovable == 0) return false;
+    // check didn't exceed pieces capacity
+    for (unsigned int i = 0; i < side.numPieces.size(); i++) {
+        if (side.numPieces[i] > Piece::maxCapacity.at(TYPES[i])) return false;
+    }
+    return true;
+}
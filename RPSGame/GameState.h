@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include "GameContainers.h"
+#include "Piece.h"
+
+
+// Both players' pieces and the rules of moving them, shared by the referee and by players that
+// search. makeMove and changeJoker apply a move with its fight and the counters it changes and
+// push what they overwrote, unmakeMove takes back the last of them, so exploring a variation
+// needs no copy of the board.
+class GameState {
+public:
+    static const int NO_FIGHT = -1;
+    struct Side {
+        std::array<unsigned int, 6> numPieces{}; // by type, in TYPES order
+        unsigned int numFlags = 0;
+        unsigned int numMovable = 0;
+    };
+    static const char TYPES[6];
+    GameState() { _undo.reserve(64); }
+    void clear();
+    const GameBoard<Piece>& board() const { return _board; }
+    const Side& side(int player) const { return _sides[player - 1]; }
+    unsigned int numFights() const { return _numFights; } // moves since the last fight
+    // adds a piece of the initial positions, fighting the piece already there, can't be taken back
+    int place(const Point& pos, const Piece& piece);
+    // both return the winner of the fight, 0 when both pieces died, or NO_FIGHT
+    int makeMove(const Point& from, const Point& to);
+    void changeJoker(const Point& pos, char rep);
+    void unmakeMove(); // of the last makeMove or changeJoker
+    void discardUndo() { _undo.clear(); } // for a caller that never takes moves back
+    bool isValidMove(const Point& from, const Point& to, int player) const;
+    bool isValidJokerChange(const Point& pos, char rep, int player) const;
+    bool isPlaying(int player) const { return isValid(side(player)); }
+    static bool isValid(const Side& side); // has a flag and a movable piece, and no more pieces than allowed
+    static void add(Side& side, const Piece& piece);
+    static int typeIndex(char type);
+private:
+    struct Change {
+        GameBoard<Piece>::Entry from; // before the change, for a joker change its square
+        GameBoard<Piece>::Entry to;
+        int fromX, fromY, toX, toY;
+        unsigned int numFights;
+        bool isJoker;
+        bool killed[2]; // of from and to
+    };
+    int fight(const Point& pos, const Piece& piece1, bool killed[2]);
+    void remove(const Piece& piece);
+    GameBoard<Piece> _board;
+    Side _sides[2];
+    unsigned int _numFights = 0;
+    std::vector<Change> _undo;
+};
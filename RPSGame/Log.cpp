@@ -0,0 +1,183 @@
+#include <condition_variable>
+#include <algorithm>
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <mutex>
+#include <array>
+#include <map>
+#include "Log.h"
+
+
+const std::map<std::string, LogLevel> LEVEL_NAMES = {
+    { "none", LogLevel::None },
+    { "error", LogLevel::Error },
+    { "warning", LogLevel::Warning },
+    { "info", LogLevel::Info },
+    { "debug", LogLevel::Debug },
+    { "trace", LogLevel::Trace },
+};
+
+// constant initialized, a player library sharing the host's Log must not reset it when loaded
+std::atomic_int Log::_level{ -1 };
+
+static const bool levelInitialized = Log::initLevel();
+
+namespace {
+
+const char* levelName(LogLevel level) {
+    switch (level) {
+    case LogLevel::Error: return "error";
+    case LogLevel::Warning: return "warning";
+    case LogLevel::Info: return "info";
+    case LogLevel::Debug: return "debug";
+    case LogLevel::Trace: return "trace";
+    case LogLevel::None:
+    default:
+        return "";
+    }
+}
+
+// single producer (the owning thread) single consumer (the flusher) ring of fixed size records,
+// when it's full records are dropped instead of blocking the producer
+class LogRing {
+public:
+    bool push(LogLevel level, const std::string& message) {
+        const auto head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) == CAPACITY) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        auto& record = _records[head % CAPACITY];
+        record.level = level;
+        record.length = std::min(message.size(), record.text.size());
+        std::memcpy(record.text.data(), message.data(), record.length);
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+    void drain(std::ostream& os) {
+        auto tail = _tail.load(std::memory_order_relaxed);
+        const auto head = _head.load(std::memory_order_acquire);
+        for (; tail != head; tail++) {
+            const auto& record = _records[tail % CAPACITY];
+            os << "[" << levelName(record.level) << "] ";
+            os.write(record.text.data(), record.length) << '\n';
+        }
+        _tail.store(tail, std::memory_order_release);
+        const auto dropped = _dropped.exchange(0, std::memory_order_relaxed);
+        if (dropped) os << "[warning] " << dropped << " log records dropped" << '\n';
+    }
+    std::atomic_bool retired{ false };
+private:
+    struct Record {
+        LogLevel level;
+        size_t length;
+        std::array<char, 240> text;
+    };
+    const static size_t CAPACITY = 512;
+    std::array<Record, CAPACITY> _records;
+    std::atomic<size_t> _head{ 0 };
+    std::atomic<size_t> _tail{ 0 };
+    std::atomic<size_t> _dropped{ 0 };
+};
+
+class Logger {
+public:
+    ~Logger() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _cv.notify_one();
+        if (_flusher.joinable()) _flusher.join();
+        flush();
+    }
+    std::shared_ptr<LogRing> addRing() {
+        auto ring = std::make_shared<LogRing>();
+        std::lock_guard<std::mutex> lock(_mutex);
+        _rings.push_back(ring);
+        if (!_flusher.joinable()) _flusher = std::thread(&Logger::flushLoop, this);
+        return ring;
+    }
+    void flush() {
+        std::lock_guard<std::mutex> flushLock(_flushMutex);
+        std::vector<std::shared_ptr<LogRing>> rings;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            rings = _rings;
+        }
+        for (const auto& ring : rings) ring->drain(std::clog);
+        // rings of finished threads are removed and drained once more, their thread may have
+        // logged its last records after the drain above and before it retired the ring
+        std::vector<std::shared_ptr<LogRing>> retired;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            const auto it = std::stable_partition(_rings.begin(), _rings.end(), [](const auto& ring) {
+                return !ring->retired.load();
+            });
+            retired.assign(it, _rings.end());
+            _rings.erase(it, _rings.end());
+        }
+        for (const auto& ring : retired) ring->drain(std::clog);
+        std::clog.flush();
+    }
+private:
+    void flushLoop() {
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (!_stop) {
+            _cv.wait_for(lock, std::chrono::milliseconds(50));
+            lock.unlock();
+            flush();
+            lock.lock();
+        }
+    }
+    std::vector<std::shared_ptr<LogRing>> _rings;
+    std::thread _flusher;
+    std::mutex _mutex;
+    std::mutex _flushMutex;
+    std::condition_variable _cv;
+    bool _stop = false;
+};
+
+Logger& logger() {
+    static Logger logger;
+    return logger;
+}
+
+// registers the thread's ring on first use and retires it when the thread exits
+class ThreadRing {
+public:
+    ThreadRing() : ring(logger().addRing()) {}
+    ~ThreadRing() { ring->retired = true; }
+    std::shared_ptr<LogRing> ring;
+};
+
+} // namespace
+
+bool Log::initLevel() {
+    const char* name = std::getenv("RPS_LOG_LEVEL");
+    auto unset = -1;
+    return _level.compare_exchange_strong(unset, static_cast<int>(parseLevel(name ? name : "none")));
+}
+
+void Log::setLevel(LogLevel level) {
+    _level = static_cast<int>(level);
+}
+
+LogLevel Log::parseLevel(const std::string& name) {
+    const auto it = LEVEL_NAMES.find(name);
+    return it == LEVEL_NAMES.end() ? LogLevel::None : it->second;
+}
+
+void Log::write(LogLevel level, const std::string& message) {
+    thread_local ThreadRing threadRing;
+    threadRing.ring->push(level, message);
+}
+
+void Log::flush() {
+    logger().flush();
+}
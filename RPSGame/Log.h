@@ -0,0 +1,52 @@
+#pragma once
+
+#include <sstream>
+#include <string>
+#include <atomic>
+
+
+enum class LogLevel {
+    None = 0,
+    Error,
+    Warning,
+    Info,
+    Debug,
+    Trace,
+};
+
+// highest level compiled in, calls above it are removed by the compiler
+#ifndef LOG_MAX_LEVEL
+#define LOG_MAX_LEVEL 5
+#endif
+
+// the runtime level defaults to $RPS_LOG_LEVEL, enabled records are pushed into a lock-free
+// ring buffer owned by the calling thread and written to std::clog by a background thread
+class Log {
+public:
+    static bool isEnabled(LogLevel level) {
+        return static_cast<int>(level) <= LOG_MAX_LEVEL
+            && static_cast<int>(level) <= _level.load(std::memory_order_relaxed);
+    }
+    static bool initLevel(); // from $RPS_LOG_LEVEL unless already set
+    static void setLevel(LogLevel level);
+    static LogLevel parseLevel(const std::string& name);
+    static void write(LogLevel level, const std::string& message);
+    static void flush();
+private:
+    static std::atomic_int _level;
+};
+
+// the message is only formatted when the level is enabled
+#define LOG(level, x) do { \
+    if (Log::isEnabled(level)) { \
+        std::ostringstream log_stream_; \
+        log_stream_ << x; \
+        Log::write(level, log_stream_.str()); \
+    } \
+} while (0)
+
+#define LOG_ERROR(x) LOG(LogLevel::Error, x)
+#define LOG_WARNING(x) LOG(LogLevel::Warning, x)
+#define LOG_INFO(x) LOG(LogLevel::Info, x)
+#define LOG_DEBUG(x) LOG(LogLevel::Debug, x)
+#define LOG_TRACE(x) LOG(LogLevel::Trace, x)
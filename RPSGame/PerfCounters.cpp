@@ -0,0 +1,149 @@
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+#include "PerfCounters.h"
+
+#ifdef __linux__
+const uint64_t EVENT_CONFIGS[PerfCounters::NUM_EVENTS] = {
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES,
+};
+#endif
+
+struct ThreadCounters {
+    int fds[PerfCounters::NUM_EVENTS] = { -1, -1, -1, -1 };
+#ifdef __linux__
+    perf_event_mmap_page* pages[PerfCounters::NUM_EVENTS] = {};
+#endif
+    bool tried = false;
+    bool isOpen = false;
+    int error = 0;
+    PerfCounters::Sample attributed;
+    ~ThreadCounters() { close(); }
+    bool open();
+    void close();
+    uint64_t read(int event) const;
+};
+
+static thread_local ThreadCounters counters;
+
+bool ThreadCounters::open() {
+    tried = true;
+#ifndef __linux__
+    error = ENOSYS; // perf_event_open is linux only
+    return false;
+#else
+    for (int event = 0; event < PerfCounters::NUM_EVENTS; event++) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = EVENT_CONFIGS[event];
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        // a group with the first counter, so the four are scheduled on the pmu together
+        fds[event] = syscall(SYS_perf_event_open, &attr, 0, -1, event == 0 ? -1 : fds[0], 0);
+        if (fds[event] < 0) {
+            error = errno;
+            close();
+            return false;
+        }
+        void* page = mmap(nullptr, sysconf(_SC_PAGESIZE), PROT_READ, MAP_SHARED, fds[event], 0);
+        pages[event] = page == MAP_FAILED ? nullptr : static_cast<perf_event_mmap_page*>(page);
+    }
+    isOpen = true;
+    return true;
+#endif
+}
+
+void ThreadCounters::close() {
+    for (int event = 0; event < PerfCounters::NUM_EVENTS; event++) {
+#ifdef __linux__
+        if (pages[event]) munmap(pages[event], sysconf(_SC_PAGESIZE));
+        pages[event] = nullptr;
+#endif
+        if (fds[event] >= 0) ::close(fds[event]);
+        fds[event] = -1;
+    }
+    isOpen = false;
+}
+
+uint64_t ThreadCounters::read(int event) const {
+#if defined(__linux__) && (defined(__x86_64__) || defined(__i386__))
+    // the kernel's protocol for reading a mapped counter, see perf_event_mmap_page
+    const auto page = pages[event];
+    if (page && page->cap_user_rdpmc) {
+        uint32_t seq;
+        uint64_t count;
+        do {
+            seq = page->lock;
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+            const auto index = page->index;
+            count = page->offset;
+            if (index == 0) break; // not on the pmu right now, read it from the kernel instead
+            const auto width = page->pmc_width;
+            auto pmc = static_cast<int64_t>(__builtin_ia32_rdpmc(index - 1));
+            pmc <<= 64 - width; // sign extended from the counter's width
+            pmc >>= 64 - width;
+            count += pmc;
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+            if (page->lock == seq) return count;
+        } while (true);
+    }
+#endif
+    uint64_t count = 0;
+    if (::read(fds[event], &count, sizeof(count)) != sizeof(count)) return 0;
+    return count;
+}
+
+PerfCounters::Sample PerfCounters::Sample::operator-(const Sample& other) const {
+    Sample sample;
+    for (int event = 0; event < NUM_EVENTS; event++) sample.counts[event] = counts[event] - other.counts[event];
+    return sample;
+}
+
+PerfCounters::Sample& PerfCounters::Sample::operator+=(const Sample& other) {
+    for (int event = 0; event < NUM_EVENTS; event++) counts[event] += other.counts[event];
+    return *this;
+}
+
+void PerfCounters::Totals::add(const Sample& sample) {
+    for (int event = 0; event < NUM_EVENTS; event++) counts[event].fetch_add(sample.counts[event], std::memory_order_relaxed);
+    samples.fetch_add(1, std::memory_order_relaxed);
+}
+
+void PerfCounters::Totals::reset() {
+    for (auto& count : counts) count = 0;
+    samples = 0;
+}
+
+PerfCounters::Measure::~Measure() {
+    const auto sample = read() - _start;
+    _totals.add(sample);
+    counters.attributed += sample;
+}
+
+bool PerfCounters::open(std::string& error) {
+    if (!counters.tried) counters.open();
+    if (!counters.isOpen) error = std::strerror(counters.error);
+    return counters.isOpen;
+}
+
+PerfCounters::Sample PerfCounters::read() {
+    Sample sample;
+    if (!counters.tried) counters.open();
+    if (!counters.isOpen) return sample;
+    for (int event = 0; event < NUM_EVENTS; event++) sample.counts[event] = counters.read(event);
+    return sample;
+}
+
+PerfCounters::Sample PerfCounters::unattributed() {
+    return read() - counters.attributed;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+
+// Per thread hardware counters through perf_event_open, counting user space only. Where the
+// kernel allows it they are read with rdpmc from the mapped counter pages, a few dozen cycles
+// a sample, otherwise with a read per counter. Counts of code measured by a Measure scope are
+// attributed to it, the rest of the thread's counts are unattributed.
+class PerfCounters {
+public:
+    enum Event { Instructions, Cycles, CacheMisses, BranchMisses, NUM_EVENTS };
+    struct Sample {
+        uint64_t counts[NUM_EVENTS] = {};
+        Sample operator-(const Sample& other) const;
+        Sample& operator+=(const Sample& other);
+    };
+    struct Totals {
+        std::atomic_ullong counts[NUM_EVENTS]{};
+        std::atomic_ullong samples{ 0 };
+        void add(const Sample& sample);
+        void reset();
+    };
+    // adds the counts from construction to destruction to totals
+    class Measure {
+    public:
+        explicit Measure(Totals& totals) : _totals(totals), _start(read()) {}
+        ~Measure();
+        Measure(const Measure&) = delete;
+        Measure& operator=(const Measure&) = delete;
+    private:
+        Totals& _totals;
+        const Sample _start;
+    };
+    static bool open(std::string& error); // this thread's counters, read opens them on first use
+    static Sample read(); // zeros when the counters can't be opened
+    static Sample unattributed(); // read minus the counts of this thread's Measure scopes
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "PlayerAlgorithm.h"
+
+
+// plain data crossing the library boundary, positions are 1-based like Point
+struct TurnEvent {
+    enum Type : uint8_t {
+        OpponentMove, // from -> to
+        Fight, // at to, piece1 and piece2 are the pieces of players 1 and 2
+    };
+    uint8_t type;
+    char piece1;
+    char piece2;
+    uint8_t winner; // of a fight, 0 if both pieces lost
+    int8_t fromX;
+    int8_t fromY;
+    int8_t toX;
+    int8_t toY;
+};
+
+struct TurnReply {
+    int8_t fromX = 0; // a move from (0, 0) loses the game like a nullptr move
+    int8_t fromY = 0;
+    int8_t toX = 0;
+    int8_t toY = 0;
+    int8_t jokerX = 0;
+    int8_t jokerY = 0;
+    char jokerRep = 0; // 0 for no joker change
+};
+
+// Optional extension of PlayerAlgorithm, detected by the referee with dynamic_cast. Instead of
+// notifyOnOpponentMove, notifyFightResult, getMove and getJokerChange, each turn is a single
+// call with the events since the player's previous turn: the fight of its own last move, the
+// opponent's move and its fight, in that order. Positioning still uses the classic calls.
+class PlayerAlgorithmV2 : public PlayerAlgorithm {
+public:
+    virtual void playTurn(const TurnEvent* events, std::size_t numEvents, TurnReply& reply) = 0;
+};
@@ -0,0 +1,55 @@
+#include <fstream>
+#include <algorithm>
+#include <cstdio>
+#include "Profile.h"
+
+// File layout, text:
+//   "RPSPROF1"
+//   a line per algorithm: id games avg_micros
+
+const std::string PROFILE_MAGIC = "RPSPROF1";
+
+// older games weigh at most as much as this many new ones, so the profile follows a changed algorithm
+const unsigned long long PROFILE_HISTORY = 1000;
+
+void Profile::add(const std::string& id, unsigned long long games, double totalMicros) {
+    if (games == 0) return;
+    auto& entry = algos[id];
+    const auto oldGames = std::min(entry.games, PROFILE_HISTORY);
+    entry.avgMicros = (entry.avgMicros * oldGames + totalMicros) / (oldGames + games);
+    entry.games = oldGames + games;
+}
+
+double Profile::unknownCost() const {
+    double sum = 0;
+    for (const auto& algo : algos) sum += algo.second.avgMicros;
+    return algos.empty() ? 0 : sum / algos.size();
+}
+
+double Profile::cost(const std::string& id, double unknown) const {
+    const auto it = algos.find(id);
+    return it != algos.end() ? it->second.avgMicros : unknown;
+}
+
+bool Profile::save(const std::string& fname) const {
+    // written aside and renamed like a checkpoint, a crash keeps the previous profile
+    const auto tmpName = fname + ".tmp";
+    {
+        std::ofstream os(tmpName, std::ios::trunc);
+        os << PROFILE_MAGIC << "\n";
+        for (const auto& algo : algos) os << algo.first << " " << algo.second.games << " " << algo.second.avgMicros << "\n";
+        if (!os.flush()) return false;
+    }
+    return std::rename(tmpName.c_str(), fname.c_str()) == 0;
+}
+
+bool Profile::load(const std::string& fname) {
+    std::ifstream is(fname);
+    std::string magic;
+    if (!(is >> magic) || magic != PROFILE_MAGIC) return false;
+    algos.clear();
+    std::string id;
+    Entry entry;
+    while (is >> id >> entry.games >> entry.avgMicros) algos[id] = entry;
+    return is.eof();
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <string>
+#include <map>
+
+
+// average duration of the games each algorithm played, kept across tournaments to estimate the
+// cost of a match as the mean of its players'. A game's duration includes both players' moves, so
+// adding the two would count every game twice.
+struct Profile {
+    struct Entry {
+        unsigned long long games = 0;
+        double avgMicros = 0;
+    };
+    std::map<std::string, Entry> algos;
+    void add(const std::string& id, unsigned long long games, double totalMicros);
+    double unknownCost() const; // of an algorithm without an entry, the average of the known ones
+    double cost(const std::string& id, double unknown) const; // of its average game
+
+    bool save(const std::string& fname) const;
+    bool load(const std::string& fname);
+};
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "DecoratedPlayerAlgorithm.h"
+#include "PerfCounters.h"
+
+
+// Measures the hardware counters of each call of a player into its algorithm's totals.
+class ProfiledCalls : public PlayerPolicy {
+public:
+    explicit ProfiledCalls(PerfCounters::Totals& totals) : _totals(&totals) {}
+    class Scope : public PerfCounters::Measure {
+    public:
+        explicit Scope(const ProfiledCalls& policy) : PerfCounters::Measure(*policy._totals) {}
+    };
+private:
+    PerfCounters::Totals* _totals;
+};
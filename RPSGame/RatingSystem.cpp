@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <cmath>
+#include "RatingSystem.h"
+
+
+const double PI = std::acos(-1.0);
+const double GLICKO_SCALE = 173.7178;
+const double GLICKO_TAU = 0.5; // constrains the volatility change over time
+const double GLICKO_EPSILON = 0.000001;
+
+static double g(double phi) {
+    return 1 / std::sqrt(1 + 3 * phi * phi / (PI * PI));
+}
+
+static double expectedScore(double mu, double muOpp, double phiOpp) {
+    return 1 / (1 + std::exp(-g(phiOpp) * (mu - muOpp)));
+}
+
+// iterative solution for the new volatility (step 5 of the paper)
+static double newVolatility(double phi, double sigma, double delta, double v) {
+    const auto a = std::log(sigma * sigma);
+    const auto f = [&](double x) {
+        const auto ex = std::exp(x);
+        const auto d = phi * phi + v + ex;
+        return ex * (delta * delta - d) / (2 * d * d) - (x - a) / (GLICKO_TAU * GLICKO_TAU);
+    };
+    auto A = a;
+    double B;
+    if (delta * delta > phi * phi + v) {
+        B = std::log(delta * delta - phi * phi - v);
+    } else {
+        auto k = 1;
+        while (f(a - k * GLICKO_TAU) < 0) k++;
+        B = a - k * GLICKO_TAU;
+    }
+    auto fA = f(A);
+    auto fB = f(B);
+    while (std::abs(B - A) > GLICKO_EPSILON) {
+        const auto C = A + (A - B) * fA / (fB - fA);
+        const auto fC = f(C);
+        if (fC * fB <= 0) {
+            A = B;
+            fA = fB;
+        } else {
+            fA /= 2;
+        }
+        B = C;
+        fB = fC;
+    }
+    return std::exp(A / 2);
+}
+
+void RatingSystem::addPlayer(const std::string& id) {
+    _ratings[id] = Rating();
+}
+
+void RatingSystem::update(const std::vector<Result>& period) {
+    // games of every player in the period, as (opponent, score)
+    std::map<std::string, std::vector<std::pair<std::string, double>>> games;
+    for (const auto& result : period) {
+        games[result.id1].emplace_back(result.id2, result.score1);
+        games[result.id2].emplace_back(result.id1, 1 - result.score1);
+    }
+    auto updated = _ratings;
+    for (auto& entry : updated) {
+        auto& rating = entry.second;
+        const auto mu = (rating.rating - 1500) / GLICKO_SCALE;
+        const auto phi = rating.deviation / GLICKO_SCALE;
+        const auto it = games.find(entry.first);
+        if (it == games.end()) { // didn't play, only the deviation grows
+            rating.deviation = std::sqrt(phi * phi + rating.volatility * rating.volatility) * GLICKO_SCALE;
+            continue;
+        }
+        double invV = 0;
+        double sum = 0;
+        for (const auto& game : it->second) {
+            const auto& opp = _ratings.at(game.first);
+            const auto muOpp = (opp.rating - 1500) / GLICKO_SCALE;
+            const auto phiOpp = opp.deviation / GLICKO_SCALE;
+            const auto e = expectedScore(mu, muOpp, phiOpp);
+            invV += g(phiOpp) * g(phiOpp) * e * (1 - e);
+            sum += g(phiOpp) * (game.second - e);
+        }
+        const auto v = 1 / invV;
+        const auto sigma = newVolatility(phi, rating.volatility, v * sum, v);
+        const auto phiStar = std::sqrt(phi * phi + sigma * sigma);
+        const auto newPhi = 1 / std::sqrt(1 / (phiStar * phiStar) + 1 / v);
+        rating.rating = 1500 + GLICKO_SCALE * (mu + newPhi * newPhi * sum);
+        rating.deviation = newPhi * GLICKO_SCALE;
+        rating.volatility = sigma;
+    }
+    _ratings = updated;
+}
+
+std::vector<std::pair<std::string, std::string>> RatingSystem::nextRound(std::mt19937& rg) const {
+    std::vector<std::pair<std::string, Rating>> players(_ratings.begin(), _ratings.end());
+    std::shuffle(players.begin(), players.end(), rg); // random order between equally certain players
+    std::stable_sort(players.begin(), players.end(), [](const auto& p1, const auto& p2) {
+        return p1.second.deviation > p2.second.deviation;
+    });
+    std::vector<bool> paired(players.size(), false);
+    std::vector<std::pair<std::string, std::string>> round;
+    for (size_t i = 0; i < players.size(); i++) {
+        if (paired[i]) continue;
+        const auto mu = (players[i].second.rating - 1500) / GLICKO_SCALE;
+        // the fisher information of a game is highest against close opponents with certain ratings
+        auto best = players.size();
+        auto bestInfo = -1.0;
+        for (size_t j = i + 1; j < players.size(); j++) {
+            if (paired[j]) continue;
+            const auto muOpp = (players[j].second.rating - 1500) / GLICKO_SCALE;
+            const auto phiOpp = players[j].second.deviation / GLICKO_SCALE;
+            const auto e = expectedScore(mu, muOpp, phiOpp);
+            const auto info = g(phiOpp) * g(phiOpp) * e * (1 - e);
+            if (info > bestInfo) {
+                best = j;
+                bestInfo = info;
+            }
+        }
+        if (best == players.size()) break; // odd one out
+        paired[i] = paired[best] = true;
+        round.emplace_back(players[i].first, players[best].first);
+    }
+    return round;
+}
+
+bool RatingSystem::isTopStable(unsigned int k, double z) const {
+    std::vector<Rating> ratings;
+    for (const auto& entry : _ratings) ratings.push_back(entry.second);
+    std::sort(ratings.begin(), ratings.end(), [](const auto& r1, const auto& r2) {
+        return r1.rating > r2.rating;
+    });
+    for (size_t i = 0; i < k && i + 1 < ratings.size(); i++) {
+        const auto gap = ratings[i].rating - ratings[i + 1].rating;
+        const auto deviation = std::sqrt(ratings[i].deviation * ratings[i].deviation
+            + ratings[i + 1].deviation * ratings[i + 1].deviation);
+        if (gap <= z * deviation) return false;
+    }
+    return true;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <random>
+#include <map>
+
+
+// Glicko-2 ratings (http://www.glicko.net/glicko/glicko2.pdf), results are applied in rating periods
+class RatingSystem {
+public:
+    struct Rating {
+        double rating = 1500;
+        double deviation = 350;
+        double volatility = 0.06;
+    };
+    struct Result {
+        std::string id1;
+        std::string id2;
+        double score1; // 1 if id1 won, 0.5 for a tie, 0 if id2 won
+    };
+    void addPlayer(const std::string& id);
+    void update(const std::vector<Result>& period);
+    const std::map<std::string, Rating>& ratings() const { return _ratings; }
+    // pairs every player, starting from the least certain ones, with the opponent
+    // whose game is expected to be the most informative
+    std::vector<std::pair<std::string, std::string>> nextRound(std::mt19937& rg) const;
+    // whether the order of the top k players, and the boundary below them, is statistically
+    // significant: every adjacent pair is separated by more than z combined deviations
+    // (one sided, 1.645 is 95% confidence that each player is above the next one)
+    bool isTopStable(unsigned int k, double z = 1.645) const;
+private:
+    std::map<std::string, Rating> _ratings;
+};
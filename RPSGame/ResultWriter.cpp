@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <cstdint>
+#include "ResultWriter.h"
+
+// Binary format, integers are little endian:
+//   "RPSRES01"
+//   per game: u8 id1 length, id1, u8 id2 length, id2, u8 winner, u32 turns,
+//             u8 reason length, reason, u32 duration in microseconds
+
+const std::string RESULTS_MAGIC = "RPSRES01";
+
+bool ResultWriter::parseFormat(const std::string& name, Format& format) {
+    if (name == "csv") {
+        format = Format::Csv;
+    } else if (name == "json") {
+        format = Format::Json;
+    } else if (name == "bin") {
+        format = Format::Binary;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool ResultWriter::open(const std::string& fname, Format format) {
+    _format = format;
+    _os.open(fname, std::ios::binary | std::ios::trunc);
+    if (!_os) return false;
+    if (_format == Format::Csv) _os << "id1,id2,winner,turns,reason,duration_us\n";
+    if (_format == Format::Binary) _os.write(RESULTS_MAGIC.data(), RESULTS_MAGIC.size());
+    _closing = false;
+    _thread = std::thread(&ResultWriter::writerThread, this);
+    return true;
+}
+
+void ResultWriter::write(Record record) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _pending.push_back(std::move(record));
+    if (_pending.size() == _BATCH) _cv.notify_one();
+}
+
+void ResultWriter::close() {
+    if (!_thread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _closing = true;
+    }
+    _cv.notify_one();
+    _thread.join();
+    _os.close();
+}
+
+void ResultWriter::writerThread() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        _cv.wait_for(lock, std::chrono::milliseconds(100), [this] { return _closing || _pending.size() >= _BATCH; });
+        const bool closing = _closing;
+        _writing.swap(_pending);
+        lock.unlock();
+        for (const auto& record : _writing) serialize(record);
+        _writing.clear();
+        _os.flush(); // so the records can be consumed while the tournament runs
+        lock.lock();
+        if (closing) return;
+    }
+}
+
+static void writeJsonString(std::ostream& os, const std::string& str) {
+    os << '"';
+    for (const auto ch : str) {
+        if (ch == '"' || ch == '\\') os << '\\';
+        os << ch;
+    }
+    os << '"';
+}
+
+template<class T>
+static void writeInt(std::ostream& os, T value) {
+    for (unsigned int i = 0; i < sizeof(T); i++) os.put(static_cast<char>((value >> (8 * i)) & 0xff));
+}
+
+static void writeShortString(std::ostream& os, const std::string& str) {
+    const auto length = std::min<std::size_t>(str.size(), UINT8_MAX);
+    writeInt<uint8_t>(os, length);
+    os.write(str.data(), length);
+}
+
+void ResultWriter::serialize(const Record& record) {
+    const auto durationUs = record.duration.count();
+    switch (_format) {
+    case Format::Csv:
+        _os << record.id1 << "," << record.id2 << "," << record.winner << "," << record.turns << ","
+            << record.reason << "," << durationUs << "\n";
+        break;
+    case Format::Json:
+        _os << "{\"id1\":";
+        writeJsonString(_os, record.id1);
+        _os << ",\"id2\":";
+        writeJsonString(_os, record.id2);
+        _os << ",\"winner\":" << record.winner << ",\"turns\":" << record.turns << ",\"reason\":\""
+            << record.reason << "\",\"duration_us\":" << durationUs << "}\n";
+        break;
+    case Format::Binary:
+        writeShortString(_os, record.id1);
+        writeShortString(_os, record.id2);
+        writeInt<uint8_t>(_os, record.winner);
+        writeInt<uint32_t>(_os, record.turns);
+        writeShortString(_os, record.reason);
+        writeInt<uint32_t>(_os, std::min<long long>(durationUs, UINT32_MAX));
+        break;
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <condition_variable>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <mutex>
+
+
+// streams a record per game to a file; workers only append to a buffer which a
+// background thread swaps out and writes, so they never wait for the disk
+class ResultWriter {
+public:
+    enum class Format {
+        Csv,
+        Json, // one object per line
+        Binary,
+    };
+    struct Record {
+        std::string id1;
+        std::string id2;
+        int winner; // 0 for a tie
+        unsigned int turns;
+        const char* reason; // see GameManager::endReason
+        std::chrono::microseconds duration;
+    };
+    ResultWriter() = default;
+    ResultWriter(const ResultWriter&) = delete;
+    ResultWriter& operator=(const ResultWriter&) = delete;
+    ~ResultWriter() { close(); }
+    bool open(const std::string& fname, Format format);
+    bool isOpen() const { return _thread.joinable(); }
+    void write(Record record);
+    void close(); // writes the remaining records
+    static bool parseFormat(const std::string& name, Format& format);
+private:
+    void writerThread();
+    void serialize(const Record& record);
+    std::ofstream _os;
+    Format _format = Format::Csv;
+    std::vector<Record> _pending; // appended by the workers
+    std::vector<Record> _writing; // owned by the writer thread
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    bool _closing = false;
+    std::thread _thread;
+    const std::size_t _BATCH = 256; // records that wake the writer before its timeout
+};
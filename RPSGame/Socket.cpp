@@ -0,0 +1,122 @@
+#include <iostream>
+#include <cstring>
+#include <unistd.h>
+#include <poll.h>
+#include <netdb.h>
+#include <sys/un.h>
+#include <sys/socket.h>
+#include "Socket.h"
+
+
+const std::string UNIX_PREFIX = "unix:";
+
+Socket::Socket(Socket&& other) : _fd(other._fd), _buffer(std::move(other._buffer)) {
+    other._fd = -1;
+}
+
+Socket& Socket::operator=(Socket&& other) {
+    if (this == &other) return *this;
+    close();
+    _fd = other._fd;
+    _buffer = std::move(other._buffer);
+    other._fd = -1;
+    return *this;
+}
+
+Socket::~Socket() {
+    close();
+}
+
+static Socket unixSocket(const std::string& path, bool toListen) {
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        std::cout << "ERROR: socket path too long " << path << std::endl;
+        return Socket();
+    }
+    std::strcpy(addr.sun_path, path.c_str());
+    Socket sock(::socket(AF_UNIX, SOCK_STREAM, 0));
+    if (!sock.isValid()) return sock;
+    if (toListen) {
+        ::unlink(path.c_str()); // stale socket of a previous run
+        if (::bind(sock.fd(), (sockaddr*)&addr, sizeof(addr)) || ::listen(sock.fd(), SOMAXCONN)) return Socket();
+    } else if (::connect(sock.fd(), (sockaddr*)&addr, sizeof(addr))) {
+        return Socket();
+    }
+    return sock;
+}
+
+static Socket tcpSocket(const std::string& address, bool toListen) {
+    const auto colon = address.rfind(':');
+    const auto host = colon == std::string::npos ? std::string() : address.substr(0, colon);
+    const auto port = colon == std::string::npos ? address : address.substr(colon + 1);
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = toListen ? AI_PASSIVE : 0;
+    addrinfo* infos = nullptr;
+    if (::getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &infos)) return Socket();
+    Socket sock;
+    for (auto info = infos; info && !sock.isValid(); info = info->ai_next) {
+        sock = Socket(::socket(info->ai_family, info->ai_socktype, info->ai_protocol));
+        if (!sock.isValid()) continue;
+        if (toListen) {
+            const int yes = 1;
+            ::setsockopt(sock.fd(), SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+            if (::bind(sock.fd(), info->ai_addr, info->ai_addrlen) || ::listen(sock.fd(), SOMAXCONN)) sock.close();
+        } else if (::connect(sock.fd(), info->ai_addr, info->ai_addrlen)) {
+            sock.close();
+        }
+    }
+    ::freeaddrinfo(infos);
+    return sock;
+}
+
+Socket Socket::listen(const std::string& address) {
+    if (address.find(UNIX_PREFIX) == 0) return unixSocket(address.substr(UNIX_PREFIX.size()), true);
+    return tcpSocket(address, true);
+}
+
+Socket Socket::connect(const std::string& address) {
+    if (address.find(UNIX_PREFIX) == 0) return unixSocket(address.substr(UNIX_PREFIX.size()), false);
+    return tcpSocket(address, false);
+}
+
+Socket Socket::accept(int timeoutMs) const {
+    pollfd pfd = { _fd, POLLIN, 0 };
+    if (::poll(&pfd, 1, timeoutMs) <= 0) return Socket();
+    return Socket(::accept(_fd, nullptr, nullptr));
+}
+
+bool Socket::sendLine(const std::string& line) {
+    const auto data = line + "\n";
+    size_t sent = 0;
+    while (sent < data.size()) {
+        const auto n = ::send(_fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        sent += n;
+    }
+    return true;
+}
+
+bool Socket::readLine(std::string& line) {
+    while (true) {
+        const auto newline = _buffer.find('\n');
+        if (newline != std::string::npos) {
+            line = _buffer.substr(0, newline);
+            _buffer.erase(0, newline + 1);
+            return true;
+        }
+        char chunk[4096];
+        const auto n = ::recv(_fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) return false;
+        _buffer.append(chunk, n);
+    }
+}
+
+void Socket::close() {
+    if (_fd >= 0) ::close(_fd);
+    _fd = -1;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+
+
+// connected or listening stream socket, addresses are "unix:<path>", "<host>:<port>" or "<port>"
+class Socket {
+public:
+    Socket() = default;
+    explicit Socket(int fd) : _fd(fd) {}
+    Socket(Socket&& other);
+    Socket& operator=(Socket&& other);
+    Socket(const Socket&) = delete;
+    Socket& operator=(const Socket&) = delete;
+    ~Socket();
+    static Socket listen(const std::string& address);
+    static Socket connect(const std::string& address);
+    Socket accept(int timeoutMs) const; // invalid socket on timeout
+    bool isValid() const { return _fd >= 0; }
+    int fd() const { return _fd; }
+    bool sendLine(const std::string& line);
+    bool readLine(std::string& line);
+    void close();
+private:
+    int _fd = -1;
+    std::string _buffer;
+};
@@ -0,0 +1,87 @@
+#include <algorithm>
+#include "SyntheticPlayerAlgorithm.h"
+
+
+const std::vector<char> SYNTHETIC_PIECES = { 'F', 'R', 'R', 'P', 'P', 'S', 'B', 'B' };
+
+SyntheticPlayerAlgorithm::SyntheticPlayerAlgorithm(std::chrono::nanoseconds moveCost) :
+    _moveCost(moveCost),
+    _rg(std::mt19937(std::random_device{}())) {}
+
+void SyntheticPlayerAlgorithm::getInitialPositions(int player, std::vector<std::unique_ptr<PiecePosition>>& positions) {
+    _player = player;
+    _opponent = _player == 1 ? 2 : 1;
+    _board.clear();
+    positions.clear();
+    // pieces are spread randomly over the two rows closest to the player
+    const auto firstRow = _player == 1 ? 1 : _board.N - 1;
+    std::vector<GamePoint> cells;
+    for (auto x = firstRow; x < firstRow + 2; x++) {
+        for (auto y = 1; y <= _board.M; y++) cells.emplace_back(x, y);
+    }
+    std::shuffle(cells.begin(), cells.end(), _rg);
+    for (unsigned int i = 0; i < SYNTHETIC_PIECES.size(); i++) {
+        const auto& pos = cells[i];
+        _board[pos] = { Piece(_player, SYNTHETIC_PIECES[i]), _player };
+        positions.push_back(std::make_unique<PiecePositionImpl>(pos.getX(), pos.getY(), SYNTHETIC_PIECES[i]));
+    }
+}
+
+void SyntheticPlayerAlgorithm::notifyOnInitialBoard(const Board& board, const std::vector<std::unique_ptr<FightInfo>>& fights) {
+    for (const auto& fight : fights) notifyFightResult(*fight);
+    for (auto x = 1; x <= _board.N; x++) {
+        for (auto y = 1; y <= _board.M; y++) {
+            GamePoint pos(x, y);
+            if (board.getPlayer(pos) == _opponent) _board[pos] = { Piece(_opponent), _opponent };
+        }
+    }
+}
+
+void SyntheticPlayerAlgorithm::notifyOnOpponentMove(const Move& move) {
+    _board[move.getTo()] = _board[move.getFrom()];
+    _board[move.getFrom()] = { Piece(), 0 };
+}
+
+void SyntheticPlayerAlgorithm::notifyFightResult(const FightInfo& fightInfo) {
+    const auto& pos = fightInfo.getPosition();
+    const auto winner = fightInfo.getWinner();
+    if (winner == 0) {
+        _board[pos] = { Piece(), 0 };
+    } else {
+        _board[pos] = { Piece(winner, fightInfo.getPiece(winner)), winner };
+    }
+}
+
+std::unique_ptr<Move> SyntheticPlayerAlgorithm::getMove() {
+    spin();
+    std::vector<std::pair<GamePoint, GamePoint>> moves;
+    for (auto x = 1; x <= _board.N; x++) {
+        for (auto y = 1; y <= _board.M; y++) {
+            GamePoint from(x, y);
+            if (_board[from].player != _player || !_board[from].piece.canMove()) continue;
+            for (auto dx = -1; dx <= 1; dx++) {
+                for (auto dy = -1; dy <= 1; dy++) {
+                    GamePoint to(x + dx, y + dy);
+                    if (!_board.isValid(to) || _board[to].player == _player) continue;
+                    moves.emplace_back(from, to);
+                }
+            }
+        }
+    }
+    if (moves.empty()) return nullptr;
+    const auto& move = moves[std::uniform_int_distribution<size_t>(0, moves.size() - 1)(_rg)];
+    const auto& from = move.first;
+    const auto& to = move.second;
+    if (_board[to].player != _opponent) _board[to] = _board[from]; // there will be no fight
+    _board[from] = { Piece(), 0 };
+    return std::make_unique<GameMove>(from.getX(), from.getY(), to.getX(), to.getY());
+}
+
+std::unique_ptr<JokerChange> SyntheticPlayerAlgorithm::getJokerChange() {
+    return nullptr;
+}
+
+void SyntheticPlayerAlgorithm::spin() const {
+    const auto until = std::chrono::steady_clock::now() + _moveCost;
+    while (std::chrono::steady_clock::now() < until) {}
+}
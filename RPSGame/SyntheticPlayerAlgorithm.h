@@ -0,0 +1,30 @@
+#pragma once
+
+#include <random>
+#include <memory>
+#include <vector>
+#include <chrono>
+#include "PlayerAlgorithm.h"
+#include "GameContainers.h"
+#include "Piece.h"
+
+
+// plays random valid moves and burns a fixed amount of CPU on every move,
+// used to benchmark the tournament independently of real players
+class SyntheticPlayerAlgorithm : public PlayerAlgorithm {
+public:
+    SyntheticPlayerAlgorithm(std::chrono::nanoseconds moveCost);
+    void getInitialPositions(int player, std::vector<std::unique_ptr<PiecePosition>>& positions) override;
+    void notifyOnInitialBoard(const Board& b, const std::vector<std::unique_ptr<FightInfo>>& fights) override;
+    void notifyOnOpponentMove(const Move& move) override;
+    void notifyFightResult(const FightInfo& fightInfo) override;
+    std::unique_ptr<Move> getMove() override;
+    std::unique_ptr<JokerChange> getJokerChange() override;
+private:
+    void spin() const;
+    std::chrono::nanoseconds _moveCost;
+    int _player = 1;
+    int _opponent = 2;
+    GameBoard<Piece> _board;
+    std::mt19937 _rg;
+};
@@ -0,0 +1,221 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "Tablebase.h"
+
+// File layout: "RPSTB002", NUM_BLOCKS + 1 uint32 block offsets, then the runs
+
+const std::string TABLEBASE_MAGIC = "RPSTB002";
+
+const char TYPES[] = { 'R', 'P', 'S' };
+
+static int typeIndex(char type) {
+    for (int i = 0; i < 3; i++) {
+        if (TYPES[i] == type) return i;
+    }
+    return -1;
+}
+
+// the 8 symmetries of the board, on 0-based coordinates
+static void transform(int t, int& x, int& y) {
+    const int n = Tablebase::N - 1;
+    if (t & 1) x = n - x;
+    if (t & 2) y = n - y;
+    if (t & 4) std::swap(x, y);
+}
+
+// the flag squares x <= y < N / 2 of the fundamental triangle are numbered row by row,
+// -1 elsewhere
+static int triangleIndex(int x, int y) {
+    if (x > y || y >= Tablebase::N / 2) return -1;
+    return y * (y + 1) / 2 + x;
+}
+
+const int DIRECTIONS[8][2] = { { -1, -1 }, { -1, 0 }, { -1, 1 }, { 0, -1 }, { 0, 1 }, { 1, -1 }, { 1, 0 }, { 1, 1 } };
+
+Tablebase::~Tablebase() {
+    if (_map) munmap(_map, _mapSize);
+}
+
+bool Tablebase::open(const std::string& fname) {
+    const int fd = ::open(fname.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat st;
+    const auto header = TABLEBASE_MAGIC.size() + (NUM_BLOCKS + 1) * sizeof(uint32_t);
+    if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < header) {
+        close(fd);
+        return false;
+    }
+    const std::size_t size = st.st_size;
+    void* map = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return false;
+    const auto bytes = static_cast<const uint8_t*>(map);
+    const auto blocks = reinterpret_cast<const uint32_t*>(bytes + TABLEBASE_MAGIC.size());
+    // the runs have to end with the file
+    if (std::memcmp(map, TABLEBASE_MAGIC.data(), TABLEBASE_MAGIC.size()) != 0 || header + 2 * std::size_t(blocks[NUM_BLOCKS]) != size) {
+        munmap(map, size);
+        return false;
+    }
+    _map = map;
+    _mapSize = size;
+    _blocks = blocks;
+    _runs = bytes + header;
+    return true;
+}
+
+std::size_t Tablebase::index(int ta, int td, int fi, int a, int d, Side toMove) {
+    return ((((std::size_t(toMove) * 3 + ta) * 3 + td) * 15 + fi) * SQUARES + a) * SQUARES + d;
+}
+
+uint8_t Tablebase::value(std::size_t index) const {
+    auto left = index % BLOCK;
+    for (auto run = _runs + 2 * std::size_t(_blocks[index / BLOCK]); ; run += 2) {
+        if (left <= run[0]) return run[1];
+        left -= run[0] + 1;
+    }
+}
+
+uint8_t Tablebase::probe(char attacker, int a, int f, char defender, int d, Side toMove) const {
+    const int ta = typeIndex(attacker);
+    const int td = typeIndex(defender);
+    if (!_runs || ta < 0 || td < 0) return 0;
+    int fx = f / N;
+    int fy = f % N;
+    for (int t = 0; t < 8; t++) {
+        int x = fx;
+        int y = fy;
+        transform(t, x, y);
+        const int fi = triangleIndex(x, y);
+        if (fi < 0) continue;
+        int ax = a / N;
+        int ay = a % N;
+        int dx = d / N;
+        int dy = d % N;
+        transform(t, ax, ay);
+        transform(t, dx, dy);
+        return value(index(ta, td, fi, ax * N + ay, dx * N + dy, toMove));
+    }
+    return 0;
+}
+
+int Tablebase::fight(char type1, char type2) {
+    if (type1 == type2) return 0;
+    const bool wins = (type1 == 'R' && type2 == 'S') || (type1 == 'P' && type2 == 'R') || (type1 == 'S' && type2 == 'P');
+    return wins ? 1 : -1;
+}
+
+// Decides the positions whose value is depth plies, from the ones decided before. A position
+// decided by another thread during this pass has the same depth and is ignored, so the
+// passes don't depend on the order the threads run in.
+void Tablebase::generateDepth(std::atomic<uint8_t>* values, uint8_t depth, std::size_t begin, std::size_t end,
+        std::atomic_bool& changed) {
+    int fSquares[15];
+    for (int y = 0; y < N / 2; y++) {
+        for (int x = 0; x <= y; x++) fSquares[triangleIndex(x, y)] = x * N + y;
+    }
+    for (auto i = begin; i < end; i++) {
+        if (values[i].load(std::memory_order_relaxed) != 0) continue;
+        auto rest = i;
+        const int d = rest % SQUARES;
+        rest /= SQUARES;
+        const int a = rest % SQUARES;
+        rest /= SQUARES;
+        const int fi = rest % 15;
+        rest /= 15;
+        const int td = rest % 3;
+        rest /= 3;
+        const int ta = rest % 3;
+        const auto toMove = static_cast<Side>(rest / 3);
+        const int f = fSquares[fi];
+        if (a == f || d == f || a == d) continue;
+        const int from = toMove == Attacker ? a : d;
+        bool win = false;
+        bool allLose = true;
+        unsigned int slowestLoss = 0;
+        for (const auto& dir : DIRECTIONS) {
+            const int x = from / N + dir[0];
+            const int y = from % N + dir[1];
+            if (x < 0 || x >= N || y < 0 || y >= N) continue;
+            const int to = x * N + y;
+            int outcome = 2; // no fight
+            unsigned int plies = 1;
+            if (toMove == Attacker) {
+                if (to == f) outcome = 1;
+                if (to == d) outcome = fight(TYPES[ta], TYPES[td]);
+            } else {
+                if (to == f) continue; // its own flag
+                if (to == a) outcome = fight(TYPES[td], TYPES[ta]);
+            }
+            if (outcome == 2) {
+                const auto next = toMove == Attacker ? index(ta, td, fi, to, d, Defender) : index(ta, td, fi, a, to, Attacker);
+                const auto value = values[next].load(std::memory_order_relaxed);
+                plies = (value & PLIES) + 1;
+                if (value == 0 || plies > depth) { // a draw or not decided yet
+                    allLose = false;
+                    continue;
+                }
+                outcome = (value & LOSS) ? 1 : -1; // the opponent's loss is our win
+            }
+            if (outcome == 1 && plies == depth) win = true;
+            if (outcome != -1) allLose = false;
+            if (outcome == -1 && plies > slowestLoss) slowestLoss = plies;
+        }
+        if (win) {
+            values[i].store(WIN | depth, std::memory_order_relaxed);
+            changed = true;
+        } else if (allLose && slowestLoss == depth) {
+            values[i].store(LOSS | depth, std::memory_order_relaxed);
+            changed = true;
+        }
+    }
+}
+
+std::size_t Tablebase::generate(const std::string& fname, unsigned int numThreads) {
+    std::unique_ptr<std::atomic<uint8_t>[]> values(new std::atomic<uint8_t>[SIZE]());
+    if (numThreads == 0) numThreads = 1;
+    // a position is decided in the pass of its depth, so a pass that decides nothing ends them
+    for (uint8_t depth = 1; depth <= PLIES; depth++) {
+        std::atomic_bool changed{ false };
+        std::vector<std::thread> threads;
+        const std::size_t size = SIZE;
+        const auto chunk = (size + numThreads - 1) / numThreads;
+        for (unsigned int t = 0; t < numThreads; t++) {
+            const auto begin = std::min(size, t * chunk);
+            const auto end = std::min(size, begin + chunk);
+            threads.emplace_back(&Tablebase::generateDepth, values.get(), depth, begin, end, std::ref(changed));
+        }
+        for (auto& thread : threads) thread.join();
+        if (!changed) break;
+    }
+    std::vector<uint32_t> blocks;
+    std::vector<uint8_t> runs;
+    for (std::size_t i = 0; i < SIZE; i++) {
+        const auto value = values[i].load(std::memory_order_relaxed);
+        if (i % BLOCK == 0) blocks.push_back(runs.size() / 2);
+        if (i % BLOCK != 0 && runs.back() == value) {
+            runs[runs.size() - 2]++; // a block's run is at most BLOCK long
+        } else {
+            runs.push_back(0);
+            runs.push_back(value);
+        }
+    }
+    blocks.push_back(runs.size() / 2);
+    const auto tmpName = fname + ".tmp";
+    {
+        std::ofstream os(tmpName, std::ios::binary | std::ios::trunc);
+        os.write(TABLEBASE_MAGIC.data(), TABLEBASE_MAGIC.size());
+        os.write(reinterpret_cast<const char*>(blocks.data()), blocks.size() * sizeof(uint32_t));
+        os.write(reinterpret_cast<const char*>(runs.data()), runs.size());
+        if (!os.flush()) return 0;
+    }
+    if (std::rename(tmpName.c_str(), fname.c_str()) != 0) return 0;
+    return TABLEBASE_MAGIC.size() + blocks.size() * sizeof(uint32_t) + runs.size();
+}
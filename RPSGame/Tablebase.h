@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+
+// Three piece endgames with full information, solved by retrograde analysis: the attacker's
+// movable piece against the defender's flag and movable piece, every fight ends the game.
+// The flag never moves and the moves are the same under the 8 symmetries of the board, so
+// the file only holds the positions with the flag in a fundamental triangle of 15 squares,
+// a byte each. The bytes are run-length coded in blocks of BLOCK with the offset of each
+// block, about a third of their size, so a probe is a symmetry lookup, an index and the
+// decoding of a single block. "tbgen" builds the file and AutoPlayerAlgorithm maps the one
+// named by $RPS_TABLEBASE.
+class Tablebase {
+public:
+    enum Side { Attacker, Defender }; // the side to move
+    static const int N = 10; // squares are (x - 1) * N + (y - 1) of the 1-based points
+    static const int SQUARES = N * N;
+    // a value is 0 for a draw, otherwise WIN or LOSS for the side to move with the plies until
+    // the game ends, the fastest win and the slowest loss
+    static const uint8_t WIN = 0x00;
+    static const uint8_t LOSS = 0x80;
+    static const uint8_t PLIES = 0x7f;
+    Tablebase() = default;
+    ~Tablebase();
+    Tablebase(const Tablebase&) = delete;
+    Tablebase& operator=(const Tablebase&) = delete;
+    bool open(const std::string& fname);
+    bool isOpen() const { return _runs != nullptr; }
+    // types are 'R', 'P' or 'S', the squares must be distinct
+    uint8_t probe(char attacker, int a, int f, char defender, int d, Side toMove) const;
+    // 1 when a piece of type1 moving onto type2 wins the fight, -1 when it loses, 0 when both die
+    static int fight(char type1, char type2);
+    // returns the size of the file, 0 when it can't be written
+    static std::size_t generate(const std::string& fname, unsigned int numThreads);
+    static const std::size_t SIZE = 2 * 9 * 15 * SQUARES * SQUARES; // of the uncompressed values
+private:
+    static const std::size_t BLOCK = 256; // values a block holds, a run doesn't cross blocks
+    static const std::size_t NUM_BLOCKS = (SIZE + BLOCK - 1) / BLOCK;
+    // the side to move varies slowest, the values of a side's positions differ little from
+    // one square of the defender to the next and the runs are long
+    static std::size_t index(int ta, int td, int fi, int a, int d, Side toMove);
+    uint8_t value(std::size_t index) const;
+    static void generateDepth(std::atomic<uint8_t>* values, uint8_t depth, std::size_t begin, std::size_t end,
+        std::atomic_bool& changed);
+    void* _map = nullptr;
+    std::size_t _mapSize = 0;
+    const uint32_t* _blocks = nullptr; // offset of the runs of each block, in runs, and of their end
+    const uint8_t* _runs = nullptr; // a run is its length - 1 and its value
+};
@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <pthread.h>
+#include <sched.h>
+#include "Topology.h"
+
+// parses a kernel cpu list like "0-3,8-11"
+static std::vector<int> parseCpuList(const std::string& list) {
+    std::vector<int> cpus;
+    std::istringstream iss(list);
+    std::string range;
+    while (std::getline(iss, range, ',')) {
+        if (range.empty() || range == "\n") continue;
+        const auto dash = range.find('-');
+        const int first = std::stoi(range.substr(0, dash));
+        const int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+        for (int cpu = first; cpu <= last; cpu++) cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+// drops the cpus the process isn't allowed to run on (e.g. taskset or a container cpuset)
+static std::vector<int> allowedCpus(const std::vector<int>& cpus) {
+#ifdef __linux__
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return cpus;
+    std::vector<int> result;
+    for (const auto cpu : cpus) {
+        if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed)) result.push_back(cpu);
+    }
+    return result;
+#else
+    return cpus;
+#endif
+}
+
+Topology Topology::detect() {
+    Topology topology;
+    for (int node = 0; ; node++) {
+        std::ifstream ifs("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if (!ifs) break;
+        std::string list;
+        std::getline(ifs, list);
+        auto cpus = allowedCpus(parseCpuList(list));
+        if (!cpus.empty()) topology._nodes.push_back(cpus);
+    }
+    if (topology._nodes.empty()) {
+        std::vector<int> cpus;
+        for (unsigned int cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); cpu++) cpus.push_back(cpu);
+        topology._nodes.push_back(allowedCpus(cpus));
+        if (topology._nodes[0].empty()) topology._nodes[0].push_back(0);
+    }
+    return topology;
+}
+
+unsigned int Topology::numCpus() const {
+    unsigned int num = 0;
+    for (const auto& cpus : _nodes) num += cpus.size();
+    return num;
+}
+
+int Topology::cpu(unsigned int i, unsigned int& node) const {
+    i %= numCpus();
+    for (node = 0; i >= _nodes[node].size(); node++) i -= _nodes[node].size();
+    return _nodes[node][i];
+}
+
+unsigned int Topology::nodeOf(unsigned int i) const {
+    i %= numCpus();
+    unsigned int node = 0;
+    for (; i >= _nodes[node].size(); node++) i -= _nodes[node].size();
+    return node;
+}
+
+bool Topology::pinToCpus(const std::vector<int>& cpus) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (const auto cpu : cpus) CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpus;
+    return false;
+#endif
+}
+
+std::vector<int> Topology::threadCpus() {
+    std::vector<int> cpus;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) != 0) return cpus;
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+    }
+#endif
+    return cpus;
+}
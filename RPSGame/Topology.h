@@ -0,0 +1,20 @@
+#pragma once
+
+#include <vector>
+
+
+// cpus of each NUMA node as listed in /sys/devices/system/node, a single node
+// with all the cpus the process may run on where that isn't available
+class Topology {
+public:
+    static Topology detect();
+    unsigned int numCpus() const;
+    const std::vector<std::vector<int>>& nodes() const { return _nodes; }
+    // the i-th cpu when they are ordered node after node
+    int cpu(unsigned int i, unsigned int& node) const;
+    unsigned int nodeOf(unsigned int i) const; // of the i-th cpu
+    static bool pinToCpus(const std::vector<int>& cpus); // pins the calling thread
+    static std::vector<int> threadCpus(); // the calling thread's affinity, empty if unknown
+private:
+    std::vector<std::vector<int>> _nodes;
+};
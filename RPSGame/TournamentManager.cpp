@@ -1,40 +1,249 @@
 #include <algorithm>
 #include <iostream>
+#include <iomanip>
+#include <sstream>
 #include <random>
+#include <cmath>
+#include <csignal>
+#include <fstream>
 #include <dlfcn.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#ifdef __linux__
+#include <elf.h>
+#include <sys/inotify.h>
+#endif
+
+extern char** environ; // for posix_spawn, not every unistd.h declares it
 #include <experimental/filesystem>
 #include "TournamentManager.h"
 #include "GameManager.h"
 #include "AlgorithmRegistration.h"
+#include "SyntheticPlayerAlgorithm.h"
+#include "AccountedPlayerAlgorithm.h"
+#include "ProfiledPlayerAlgorithm.h"
+#include "Log.h"
 
 
 AlgorithmRegistration::AlgorithmRegistration(std::string id, std::function<std::unique_ptr<PlayerAlgorithm>()> factoryMethod) {
 	TournamentManager::getTournamentManager().registerAlgorithm(id, factoryMethod);
 }
 
+AlgorithmRegistration::AlgorithmRegistration(std::string id, std::function<std::unique_ptr<PlayerAlgorithm>()> factoryMethod,
+        AlgorithmInfo info) {
+	TournamentManager::getTournamentManager().registerAlgorithm(id, factoryMethod, info);
+}
+
 TournamentManager TournamentManager::_singleton;
 
-void TournamentManager::registerAlgorithm(std::string id, std::function<std::unique_ptr<PlayerAlgorithm>()> factoryMethod) {
-	if(_algos.find(id) != _algos.end()) {
-        std::cout << "ERROR: " << id << " is registered, skipping" << std::endl;
-	}
-	_algos[id] = factoryMethod;
-	_scores[id] = 0;
+thread_local TournamentManager::LoadedLib* TournamentManager::_loadingLib = nullptr;
+
+void TournamentManager::registerAlgorithm(std::string id, std::function<std::unique_ptr<PlayerAlgorithm>()> factoryMethod,
+        AlgorithmInfo info) {
+    if (_loadingLib) {
+        _loadingLib->algos.push_back({ id, factoryMethod, info });
+        return;
+    }
+    LoadedLib lib;
+    lib.algos.push_back({ id, factoryMethod, info });
+    commitLib(lib, {});
+}
+
+std::vector<std::string> TournamentManager::LoadedLib::ids() const {
+    std::vector<std::string> ids;
+    for (const auto& algo : algos) ids.push_back(algo.id);
+    return ids;
+}
+
+// registers the algorithms of a library that passed its checks, in one step, replacing
+// those of its previous version: their queued games are dropped and the games in flight
+// belong to an older generation
+void TournamentManager::commitLib(const LoadedLib& lib, const std::vector<std::string>& replaced) {
+    std::lock_guard<std::mutex> lock(_algosMutex);
+    std::lock_guard<std::mutex> scoresLock(_scoresMutex);
+    const auto generation = ++_generation;
+    for (const auto& algo : lib.algos) {
+        if (_algos.find(algo.id) != _algos.end() && replaced.empty()) {
+            std::cout << "ERROR: " << algo.id << " is registered, skipping" << std::endl;
+        }
+        _algos[algo.id] = algo.factory;
+        _algoLibs[algo.id] = lib.handle;
+        _scores[algo.id] = 0;
+        _stats[algo.id].reset();
+        _generations[algo.id] = generation;
+        if (algo.info.deterministic) {
+            _deterministic.insert(algo.id);
+        } else {
+            _deterministic.erase(algo.id);
+        }
+    }
+    if (replaced.empty()) return;
+    {
+        std::lock_guard<std::mutex> memoLock(_memoMutex); // results of the previous version can't be reused
+        _memo.clear();
+    }
+    _games.erase(std::remove_if(_games.begin(), _games.end(), [&replaced](const Match& match) {
+        return std::count(replaced.begin(), replaced.end(), std::get<0>(match)) ||
+            std::count(replaced.begin(), replaced.end(), std::get<1>(match));
+    }), _games.end());
+}
+
+// with _algosMutex held
+bool TournamentManager::isStale(const Match& match) const {
+    for (const auto& id : { std::get<0>(match), std::get<1>(match) }) {
+        const auto it = _generations.find(id);
+        if (it != _generations.end() && it->second > std::get<3>(match)) return true;
+    }
+    return false;
 }
 
+// NUMA node of the worker running on this thread
+static thread_local unsigned int workerNode = 0;
+
 void TournamentManager::run() {
+    _topology = Topology::detect();
+    if (maxThreads == 0) maxThreads = _topology.numCpus();
+    _nodeGames.assign(_topology.nodes().size(), 0);
+    if (!pin.empty() && pin != "cores" && pin != "nodes") {
+        std::cout << "ERROR: unknown -pin " << pin << ", expected cores or nodes" << std::endl;
+        pin.clear();
+    }
+    if (!schedule.empty() && schedule != "ljf") {
+        std::cout << "ERROR: unknown -schedule " << schedule << ", expected ljf" << std::endl;
+        schedule.clear();
+    }
+    if ((memStats || memCap > 0) && !AllocAccounting::compiled) {
+        std::cout << "ERROR: -memstats and -memcap need a build with ALLOC_ACCOUNTING=1, ignoring" << std::endl;
+        memStats = false;
+        memCap = 0;
+    }
+    std::string perfError;
+    if (perf && !PerfCounters::open(perfError)) {
+        std::cout << "ERROR: hardware counters are unavailable (" << perfError << "), ignoring -perf" << std::endl;
+        perf = false;
+    }
+    if (benchAlgos > 0) return runBenchmark();
+    if (!resultsFile.empty() && !_resultWriter.open(resultsFile, resultsFormat)) {
+        std::cout << "ERROR: can't write results to " << resultsFile << std::endl;
+    }
+    if (serve) return runServer();
     loadSharedLibs();
     if (_algos.size() < 2) return; // not enough players
-    initGames();
-    // init all worker threads
+    if (!workerAddress.empty()) {
+        runWorkers(maxThreads);
+        _resultWriter.close();
+        return freeSharedLibs();
+    }
+    if (rated && !checkpointFile.empty()) {
+        std::cout << "ERROR: checkpoints aren't supported for rated tournaments, ignoring" << std::endl;
+        checkpointFile.clear();
+    }
+    // every run adds to the profile, a later ljf run schedules with it
+    if (!_profile.load(profileFile) && schedule == "ljf") {
+        LOG_INFO("no profile in " << profileFile << ", games are played in the drawing order");
+    }
+    if (resume) {
+        if (!resumeGames()) return freeSharedLibs();
+    } else {
+        initGames();
+    }
+    orderGames();
+    std::thread checkpoints;
+    _stopCheckpoints = false;
+    if (!checkpointFile.empty()) {
+        _checkpointGames.clear();
+        for (const auto& match : _games) _checkpointGames.emplace_back(std::get<0>(match), std::get<1>(match), std::get<2>(match));
+        checkpoints = std::thread(&TournamentManager::checkpointThread, this);
+    }
+    if (!coordinatorAddress.empty()) {
+        runCoordinator();
+    } else {
+        runWorkers(maxThreads);
+    }
+    if (checkpoints.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(_checkpointMutex);
+            _stopCheckpoints = true;
+        }
+        _checkpointCv.notify_one();
+        checkpoints.join();
+        saveCheckpoint(); // the final state, resuming it just outputs the results
+    }
+    _resultWriter.close();
+    if (rated && !_pendingResults.empty()) _ratingSystem.update(_pendingResults);
+    outputResults();
+    if (stats) outputStats();
+    if (memStats) outputMemStats();
+    if (perf) outputPerf();
+    saveProfile();
+    freeSharedLibs();
+}
+
+void TournamentManager::runWorkers(unsigned int numThreads) {
+    auto worker = !workerAddress.empty() ? &TournamentManager::remoteWorkerThread :
+        (interleave > 1 ? &TournamentManager::interleavedWorkerThread : &TournamentManager::workerThread);
+    _nodeGames.assign(_topology.nodes().size(), 0);
+    const auto start = std::chrono::steady_clock::now();
     std::vector<std::thread> threads;
-    for (unsigned int i = 0; i < maxThreads - 1; i++) {
-        threads.emplace_back(&TournamentManager::workerThread, this);
+    for (unsigned int i = 1; i < numThreads; i++) {
+        // pinned before the worker allocates anything, so its GameManager and the
+        // players it creates are first touched, and therefore placed, on its own node
+        threads.emplace_back([this, worker, i] {
+            pinWorker(i);
+            (this->*worker)();
+        });
     }
-    workerThread(); // main thread should also participate
+    // the main thread works as worker 0, and gets its own affinity back once the workers are done
+    const auto mainCpus = pin.empty() ? std::vector<int>() : Topology::threadCpus();
+    pinWorker(0);
+    (this->*worker)(); // main thread should also participate
     for (auto& thread : threads) thread.join();
-    output();
-    freeSharedLibs();
+    if (!mainCpus.empty() && !Topology::pinToCpus(mainCpus)) LOG_WARNING("can't restore the main thread's affinity");
+    workerNode = 0;
+    const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    _workSeconds = seconds;
+    if (!pin.empty() && workerAddress.empty()) outputNodeThroughput(numThreads, seconds);
+    // the games of an interleaving worker overlap, their durations don't add up to its busy time
+    if (!schedule.empty() && workerAddress.empty() && interleave <= 1) outputMakespan(numThreads, seconds);
+}
+
+// the ideal makespan has the game time spread evenly over the workers, and can't be
+// shorter than the longest game
+void TournamentManager::outputMakespan(unsigned int numThreads, double seconds) const {
+    const auto ideal = std::max(_gameMicros / 1e6 / numThreads, _longestGameMicros / 1e6);
+    std::cerr << "makespan " << std::fixed << std::setprecision(3) << seconds << " sec, ideal " << ideal << " sec ("
+        << std::setprecision(1) << (ideal > 0 ? 100.0 * (seconds - ideal) / ideal : 0.0) << "% over)" << std::endl;
+}
+
+void TournamentManager::pinWorker(unsigned int worker) {
+    workerNode = 0;
+    if (pin.empty()) return;
+    bool pinned = false;
+    if (pin == "cores") {
+        const auto cpu = _topology.cpu(worker, workerNode);
+        pinned = Topology::pinToCpus({ cpu });
+    } else if (pin == "nodes") {
+        workerNode = worker % _topology.nodes().size();
+        pinned = Topology::pinToCpus(_topology.nodes()[workerNode]);
+    }
+    if (!pinned) LOG_WARNING("can't pin worker " << worker << " to " << pin);
+}
+
+void TournamentManager::outputNodeThroughput(unsigned int numThreads, double seconds) const {
+    for (unsigned int node = 0; node < _nodeGames.size(); node++) {
+        unsigned int numWorkers = 0;
+        for (unsigned int worker = 0; worker < numThreads; worker++) {
+            // as pinWorker places them
+            const auto nodeOfWorker = pin == "cores" ? _topology.nodeOf(worker) : worker % _topology.nodes().size();
+            numWorkers += nodeOfWorker == node;
+        }
+        if (numWorkers == 0) continue;
+        std::cerr << "node " << node << ": " << numWorkers << " workers, " << _nodeGames[node] << " games, "
+            << std::fixed << std::setprecision(1) << _nodeGames[node] / seconds << " games/sec" << std::endl;
+    }
 }
 
 bool TournamentManager::isValidLib(const std::string fname) const {
@@ -44,24 +253,193 @@ bool TournamentManager::isValidLib(const std::string fname) const {
 	return true;
 }
 
+// reason fname isn't a shared object for this machine, empty if it is; elsewhere than linux
+// the libraries aren't ELF files and dlopen is left to reject them
+static std::string checkElfHeader(const std::string& fname) {
+#ifndef __linux__
+    (void)fname;
+    return "";
+#else
+    static const auto readHeader = [](const std::string& fname, Elf64_Ehdr& header) {
+        std::ifstream ifs(fname, std::ios::binary);
+        return static_cast<bool>(ifs.read(reinterpret_cast<char*>(&header), sizeof(header)));
+    };
+    Elf64_Ehdr self;
+    Elf64_Ehdr header;
+    if (!readHeader(fname, header)) return "too short for an ELF header";
+    if (std::string(reinterpret_cast<char*>(header.e_ident), SELFMAG) != ELFMAG) return "not an ELF file";
+    if (header.e_type != ET_DYN) return "not a shared object";
+    // the class, byte order and machine have to be those of this executable
+    if (!readHeader("/proc/self/exe", self)) return "";
+    if (header.e_ident[EI_CLASS] != self.e_ident[EI_CLASS] || header.e_ident[EI_DATA] != self.e_ident[EI_DATA] ||
+        header.e_machine != self.e_machine) {
+        return "built for another architecture";
+    }
+    return "";
+#endif
+}
+
+// Preflight: the names and ELF headers are checked and the libraries are loaded with eager
+// binding by a pool of threads, then each one plays a smoke game in a child process.
+// A library failing any step is rejected before the tournament starts.
 void TournamentManager::loadSharedLibs() {
     namespace fs = std::experimental::filesystem::v1;
     if (!fs::is_directory(path)) return;
+    std::vector<fs::path> files;
     for (const auto& file : fs::directory_iterator(path)) {
-        if (file.path().extension() != ".so") continue;
-        if (file.path().string().find("RSPPlayer_") == 0) continue;
-        void* lib = dlopen(file.path().c_str(), RTLD_LAZY);
-        if (lib) {
-            _libs.push_back(lib);
+        if (isValidLib(file.path().filename().string())) files.push_back(file.path());
+    }
+    std::vector<std::string> errors(files.size());
+    std::vector<LoadedLib> libs(files.size());
+    std::vector<std::string> loaded(files.size()); // the files to smoke test
+    std::atomic_uint nextFile{ 0 };
+    const auto preflight = [&] {
+        for (unsigned int i; (i = nextFile++) < files.size(); ) {
+            errors[i] = checkElfHeader(files[i].string());
+            if (errors[i].empty()) libs[i] = loadLib(files[i].string(), files[i].filename().string(), errors[i]);
+            if (errors[i].empty()) loaded[i] = files[i].string();
+        }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned int i = 1; i < std::min<std::size_t>(maxThreads, files.size()); i++) threads.emplace_back(preflight);
+    preflight();
+    for (auto& thread : threads) thread.join();
+    const auto smokeErrors = smokeTests(loaded);
+    for (unsigned int i = 0; i < files.size(); i++) {
+        if (errors[i].empty()) errors[i] = smokeErrors[i];
+        if (errors[i].empty()) {
+            commitLib(libs[i], {});
         } else {
-            std::cout << "Error loading " << dlerror() << std::endl;
+            std::cout << "ERROR: rejecting " << files[i].filename().string() << ": " << errors[i] << std::endl;
         }
     }
 }
 
+// dlopens a player library and returns what it registered, without registering it; the
+// library stays loaded as long as one of its algorithms is registered or one of its players is alive
+TournamentManager::LoadedLib TournamentManager::loadLib(const std::string& fname, const std::string& name,
+        std::string& error) {
+    LoadedLib lib;
+    _loadingLib = &lib;
+    // eager binding, so a missing symbol fails here and not in the middle of a game
+    void* handle = dlopen(fname.c_str(), RTLD_NOW | RTLD_LOCAL);
+    _loadingLib = nullptr;
+    if (!handle) {
+        error = dlerror();
+        return {};
+    }
+    lib.handle = std::shared_ptr<void>(handle, [](void* handle) { dlclose(handle); });
+    // RSPPlayer_<id>.so has to define register_me_<id>, see REGISTER_ALGORITHM
+    const std::string prefix = "RSPPlayer_";
+    const auto symbol = "register_me_" + name.substr(prefix.length(), name.length() - prefix.length() - 3);
+    if (!dlsym(handle, symbol.c_str())) {
+        error = "no " + symbol + " symbol";
+    } else if (lib.algos.empty()) {
+        error = "no algorithm was registered";
+    }
+    if (!error.empty()) return {};
+    return lib;
+}
+
+// every library plays a game of each of its algorithms against a synthetic player in a
+// new process of this executable (see runSmokeGames), so a crash or a hang rejects only that
+// library; it's spawned rather than forked, a child forked while workers run could inherit
+// a lock one of them holds. Returns the reason each library failed, empty if it passed or
+// its fname is empty
+std::vector<std::string> TournamentManager::smokeTests(const std::vector<std::string>& fnames) {
+    std::vector<std::string> errors(fnames.size());
+    std::vector<pid_t> children(fnames.size(), 0);
+#ifdef __linux__
+    const std::string exe = "/proc/self/exe";
+#else
+    const std::string exe = executable;
+#endif
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+    posix_spawn_file_actions_adddup2(&actions, STDOUT_FILENO, STDERR_FILENO);
+    for (unsigned int i = 0; i < fnames.size(); i++) {
+        if (fnames[i].empty()) continue;
+        std::string args[] = { exe, "-smoke", fnames[i] };
+        char* argv[] = { &args[0][0], &args[1][0], &args[2][0], nullptr };
+        if (posix_spawnp(&children[i], exe.c_str(), &actions, nullptr, argv, environ) != 0) {
+            children[i] = 0; // can't check it, the library is accepted as is
+        }
+    }
+    posix_spawn_file_actions_destroy(&actions);
+    const auto deadline = std::chrono::steady_clock::now() + _SMOKE_TIMEOUT;
+    for (unsigned int left = std::count_if(children.begin(), children.end(), [](pid_t pid) { return pid > 0; }); left > 0; ) {
+        const auto timedOut = std::chrono::steady_clock::now() > deadline;
+        for (unsigned int i = 0; i < children.size(); i++) {
+            if (children[i] <= 0) continue;
+            if (timedOut) kill(children[i], SIGKILL);
+            int status;
+            if (waitpid(children[i], &status, timedOut ? 0 : WNOHANG) != children[i]) continue;
+            if (timedOut) {
+                errors[i] = "smoke game timed out";
+            } else if (WIFSIGNALED(status)) {
+                errors[i] = "smoke game crashed with signal " + std::to_string(WTERMSIG(status));
+            } else if (WEXITSTATUS(status) != 0) {
+                errors[i] = "smoke game exited with status " + std::to_string(WEXITSTATUS(status));
+            }
+            children[i] = 0;
+            left--;
+        }
+        if (left > 0) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return errors;
+}
+
+// the -smoke process of smokeTests: loads the library and plays each of its algorithms on either
+// side against a synthetic player, which positions apart from it so the game gets to its moves
+int TournamentManager::runSmokeGames() {
+    Log::setLevel(LogLevel::None);
+    if (!dlopen(smokeLib.c_str(), RTLD_NOW | RTLD_LOCAL)) return 1;
+    GameManager gameManager;
+    const auto synthetic = [] { return std::make_shared<SyntheticPlayerAlgorithm>(std::chrono::nanoseconds(0)); };
+    for (const auto& algo : _algos) {
+        gameManager.playRound(algo.second(), synthetic());
+        gameManager.playRound(synthetic(), algo.second());
+    }
+    return 0;
+}
+
 void TournamentManager::freeSharedLibs() {
     _algos.clear();
-    for (const auto& lib : _libs) dlclose(lib);
+    _algoLibs.clear();
+}
+
+std::shared_ptr<PlayerAlgorithm> TournamentManager::createPlayer(const std::string& id) {
+    std::shared_ptr<void> lib; // released after factory, whose code may be in the library
+    std::function<std::unique_ptr<PlayerAlgorithm>()> factory;
+    PerfCounters::Totals* perfTotals;
+    {
+        std::lock_guard<std::mutex> lock(_algosMutex);
+        lib = _algoLibs[id];
+        factory = _algos[id];
+        perfTotals = &_stats[id].perf;
+    }
+    const auto construct = [&] {
+        if (!perf) return factory();
+        PerfCounters::Measure measure(*perfTotals);
+        return factory();
+    };
+    std::unique_ptr<PlayerAlgorithm> algo;
+    // past the last slot an algorithm isn't accounted, rather than charged to another slot
+    const auto slot = memStats || memCap > 0 ? AllocAccounting::slot(id) : AllocAccounting::NO_SLOT;
+    if (slot != AllocAccounting::NO_SLOT) {
+        {
+            AllocAccounting::Scope scope(slot);
+            algo = construct();
+        }
+        algo = decoratePlayer(std::move(algo), AccountedCalls(slot, memCap));
+    } else {
+        algo = construct();
+    }
+    if (perf) algo = decoratePlayer(std::move(algo), ProfiledCalls(*perfTotals));
+    // the player keeps its library loaded, so a replaced version is unloaded only
+    // after the games still using it are done
+    return std::shared_ptr<PlayerAlgorithm>(algo.release(), [lib](PlayerAlgorithm* algo) { delete algo; });
 }
 
 std::pair<int, int> chooseTwoGames(const std::vector<std::pair<std::string, unsigned int>>& games){
@@ -75,13 +453,15 @@ std::pair<int, int> chooseTwoGames(const std::vector<std::pair<std::string, unsi
 }
 
 void TournamentManager::initGames() {
+    _gamesPlayed = 0;
+    if (rated) return initRatedGames();
     _games.clear();
     std::vector<std::pair<std::string, unsigned int>> numGames;
     for (auto& algo : _algos) numGames.emplace_back(algo.first, _MAX_GAMES);
     while (numGames.size() > 1) {
         auto indices = chooseTwoGames(numGames);
         // push valid game(two algo's) to _games
-        _games.emplace_back(numGames[indices.first].first, numGames[indices.second].first, true);
+        _games.emplace_back(numGames[indices.first].first, numGames[indices.second].first, true, 0);
         numGames[indices.first].second--;
         numGames[indices.second].second--;
         // remove algo's which complete 30 games
@@ -101,23 +481,76 @@ void TournamentManager::initGames() {
         }
     }
     while (algo.second > 0) {
-        _games.emplace_back(algo.first, opponent, false);
+        _games.emplace_back(algo.first, opponent, false, 0);
         algo.second--;
     }
 }
 
-void TournamentManager::workerThread() {
-    GameManager gameManager;
-    while (true) {
-        std::unique_lock<std::mutex> lock(_scoresMutex);
-        if (_games.empty()) return; // no games left
-        auto match = _games.front();
-        _games.pop_front();
-        lock.unlock(); // allow other threads to deque for matches
-        const auto& id1 = std::get<0>(match);
-        const auto& id2 = std::get<1>(match);
-        bool toUpdateScore = std::get<2>(match);
-        auto winner = gameManager.playRound(_algos[id1](), _algos[id2]());
+void TournamentManager::initRatedGames() {
+    _games.clear();
+    _pendingResults.clear();
+    _ratingSystem = RatingSystem();
+    for (const auto& algo : _algos) _ratingSystem.addPlayer(algo.first);
+    // same total number of games as a regular tournament, scheduled one round at a time
+    _ratedGamesLeft = _ratedGamesBudget = _MAX_GAMES * _algos.size() / 2;
+    _converged = false;
+    scheduleRatedGames();
+}
+
+bool TournamentManager::scheduleRatedGames() {
+    if (_ratedGamesLeft == 0 || _converged) return false;
+    std::lock_guard<std::mutex> lock(_ratingsMutex);
+    for (const auto& pair : _ratingSystem.nextRound(_rg)) {
+        if (_ratedGamesLeft == 0) break;
+        _games.emplace_back(pair.first, pair.second, true, 0);
+        _ratedGamesLeft--;
+    }
+    orderGames();
+    return !_games.empty();
+}
+
+void TournamentManager::commitResults(std::vector<RatingSystem::Result>& results) {
+    std::lock_guard<std::mutex> lock(_ratingsMutex);
+    _pendingResults.insert(_pendingResults.end(), results.begin(), results.end());
+    results.clear();
+    // a rating period ends after about two games per player
+    if (_pendingResults.size() < _algos.size()) return;
+    _ratingSystem.update(_pendingResults);
+    _pendingResults.clear();
+    if (convergeTopK > 0 && _ratingSystem.isTopStable(convergeTopK)) _converged = true;
+}
+
+bool TournamentManager::nextMatch(Match& match, bool wait) {
+    const auto lockStart = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(_scoresMutex);
+    _lockWaitNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - lockStart).count();
+    if (_converged) _games.clear(); // the remaining games won't change the top ranking
+    while (_games.empty() && !(rated && scheduleRatedGames())) {
+        if (!_serving || !wait) return false; // no games left
+        _gamesCv.wait(lock);
+    }
+    match = _games.front();
+    _games.pop_front();
+    std::get<3>(match) = _generation;
+    _inFlight.insert(match);
+    return true;
+}
+
+void TournamentManager::recordResult(const Match& match, int winner, std::vector<RatingSystem::Result>& results) {
+    const auto& id1 = std::get<0>(match);
+    const auto& id2 = std::get<1>(match);
+    bool toUpdateScore = std::get<2>(match);
+    {
+        // under the lock so a checkpoint never sees the score without the game being done, and
+        // _algosMutex keeps the algorithms from being replaced in between
+        const auto lockStart = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> algosLock(_algosMutex);
+        std::lock_guard<std::mutex> lock(_scoresMutex);
+        _lockWaitNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - lockStart).count();
+        _inFlight.erase(_inFlight.find(match));
+        _nodeGames[workerNode]++;
+        if (isStale(match)) return; // a game of a replaced version
+        if (!checkpointFile.empty()) _finishedGames.emplace_back(id1, id2, toUpdateScore);
         if (winner == 1) {
             _scores[id1] += 3;
         } else if (winner == 2 && toUpdateScore) {
@@ -127,6 +560,513 @@ void TournamentManager::workerThread() {
             _scores[id2]++;
         }
     }
+    _gamesPlayed++;
+    if (rated) {
+        results.push_back({ id1, id2, winner == 1 ? 1.0 : (winner == 2 ? 0.0 : 0.5) });
+        if (results.size() >= _RESULTS_BATCH) commitResults(results);
+    }
+}
+
+bool TournamentManager::isFinished() {
+    std::lock_guard<std::mutex> lock(_scoresMutex);
+    const auto moreRatedGames = rated && !_converged && _ratedGamesLeft > 0;
+    return _games.empty() && _inFlight.empty() && !moreRatedGames;
+}
+
+int TournamentManager::playGame(GameManager& gameManager, const Match& match) {
+    const auto start = std::chrono::steady_clock::now();
+    GameManager::GameResult result;
+    const auto memoized = resultOf(gameManager, match, result);
+    finishGame(match, result, start, memoized);
+    return result.winner;
+}
+
+bool TournamentManager::resultOf(GameManager& gameManager, const Match& match, GameManager::GameResult& result) {
+    if (lookupMemo(match, result)) return true;
+    const auto engineStart = perf ? PerfCounters::unattributed() : PerfCounters::Sample();
+    result = gameManager.playRound(createPlayer(std::get<0>(match)), createPlayer(std::get<1>(match)));
+    if (perf) _enginePerf.add(PerfCounters::unattributed() - engineStart);
+    storeMemo(match, result);
+    return false;
+}
+
+// results of games between deterministic algorithms, the order matters as it decides who starts
+bool TournamentManager::lookupMemo(const Match& match, GameManager::GameResult& result) {
+    {
+        std::lock_guard<std::mutex> lock(_algosMutex);
+        if (!_deterministic.count(std::get<0>(match)) || !_deterministic.count(std::get<1>(match))) return false;
+    }
+    _memoLookups.fetch_add(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(_memoMutex);
+    const auto it = _memo.find(std::get<0>(match) + " " + std::get<1>(match));
+    if (it == _memo.end()) return false;
+    _memoHits.fetch_add(1, std::memory_order_relaxed);
+    result = it->second;
+    return true;
+}
+
+void TournamentManager::storeMemo(const Match& match, const GameManager::GameResult& result) {
+    {
+        std::lock_guard<std::mutex> lock(_algosMutex);
+        if (!_deterministic.count(std::get<0>(match)) || !_deterministic.count(std::get<1>(match))) return;
+        if (isStale(match)) return;
+    }
+    std::lock_guard<std::mutex> lock(_memoMutex);
+    _memo.emplace(std::get<0>(match) + " " + std::get<1>(match), result);
+}
+
+void TournamentManager::finishGame(const Match& match, const GameManager::GameResult& result,
+        std::chrono::steady_clock::time_point start, bool memoized) {
+    const auto& id1 = std::get<0>(match);
+    const auto& id2 = std::get<1>(match);
+    const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    const unsigned long long micros = duration.count();
+    _gameMicros.fetch_add(micros, std::memory_order_relaxed);
+    auto longest = _longestGameMicros.load(std::memory_order_relaxed);
+    while (micros > longest && !_longestGameMicros.compare_exchange_weak(longest, micros, std::memory_order_relaxed)) {}
+    {
+        // counted under the lock, so a replacing version never starts with the previous one's games
+        std::lock_guard<std::mutex> lock(_algosMutex);
+        if (isStale(match)) return;
+        AlgorithmStats* stats[2] = { &_stats[id1], &_stats[id2] };
+        stats[0]->add(result, 0);
+        stats[1]->add(result, 1);
+        if (!memoized) { // a memoized game says nothing about how long the algorithms take
+            for (auto algoStats : stats) {
+                algoStats->playedGames.fetch_add(1, std::memory_order_relaxed);
+                algoStats->micros.fetch_add(micros, std::memory_order_relaxed);
+            }
+        }
+    }
+    if (_resultWriter.isOpen()) _resultWriter.write({ id1, id2, result.winner, result.turns, result.endReason(), duration });
+}
+
+// longest job first: the expensive games start early, so the last games to finish are short
+// ones and the workers run out of work at about the same time
+void TournamentManager::orderGames() {
+    if (schedule != "ljf" || _profile.algos.empty()) return;
+    // costed once per game before sorting, the comparisons only compare numbers
+    const auto unknown = _profile.unknownCost();
+    std::vector<std::pair<double, Match>> games;
+    games.reserve(_games.size());
+    for (auto& match : _games) {
+        const auto cost = (_profile.cost(std::get<0>(match), unknown) + _profile.cost(std::get<1>(match), unknown)) / 2;
+        games.emplace_back(cost, std::move(match));
+    }
+    std::stable_sort(games.begin(), games.end(), [](const std::pair<double, Match>& game1, const std::pair<double, Match>& game2) {
+        return game1.first > game2.first;
+    });
+    _games.clear();
+    for (auto& game : games) _games.push_back(std::move(game.second));
+}
+
+void TournamentManager::saveProfile() {
+    for (const auto& p : _stats) _profile.add(p.first, p.second.playedGames, p.second.micros);
+    if (!_profile.save(profileFile)) std::cout << "ERROR: can't write profile '" << profileFile << "'" << std::endl;
+}
+
+void TournamentManager::AlgorithmStats::add(const GameManager::GameResult& result, int player) {
+    games.fetch_add(1, std::memory_order_relaxed);
+    turns.fetch_add(result.turns, std::memory_order_relaxed);
+    if (result.fightsThreshold) fightsThreshold.fetch_add(1, std::memory_order_relaxed);
+    if (result.winner == 0) {
+        ties.fetch_add(1, std::memory_order_relaxed);
+    } else if (result.winner == player + 1) {
+        wins.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        losses[static_cast<int>(result.status[player])].fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void TournamentManager::AlgorithmStats::reset() {
+    games = wins = ties = turns = fightsThreshold = playedGames = micros = 0;
+    perf.reset();
+    for (auto& count : losses) count = 0;
+}
+
+void TournamentManager::workerThread() {
+    GameManager gameManager;
+    std::vector<RatingSystem::Result> results;
+    Match match;
+    while (nextMatch(match)) {
+        auto winner = playGame(gameManager, match);
+        recordResult(match, winner, results);
+    }
+    if (!results.empty()) commitResults(results);
+}
+
+// Keeps up to interleave games in flight and advances all of them a turn per pass. The games
+// are ordered by the algorithm to move, so each algorithm's turns run back to back while its
+// code and data are hot, and a game waiting on a slow player doesn't hold up new games.
+void TournamentManager::interleavedWorkerThread() {
+    struct Slot {
+        GameManager gameManager;
+        Match match;
+        std::chrono::steady_clock::time_point start;
+        const std::string& mover() const { return gameManager.nextPlayer() == 1 ? std::get<0>(match) : std::get<1>(match); }
+    };
+    std::vector<std::unique_ptr<Slot>> slots;
+    std::vector<std::unique_ptr<Slot>> freeSlots; // reused, a GameManager holds a whole board
+    std::vector<RatingSystem::Result> results;
+    bool moreGames = true;
+    while (true) {
+        while (moreGames && slots.size() < interleave) {
+            auto slot = freeSlots.empty() ? std::make_unique<Slot>() : std::move(freeSlots.back());
+            if (!freeSlots.empty()) freeSlots.pop_back();
+            // waits for games (in serve mode) only when there is nothing else to play
+            if (!nextMatch(slot->match, slots.empty())) {
+                freeSlots.push_back(std::move(slot));
+                moreGames = false;
+                break;
+            }
+            slot->start = std::chrono::steady_clock::now();
+            GameManager::GameResult result;
+            if (lookupMemo(slot->match, result)) {
+                finishGame(slot->match, result, slot->start, true);
+                recordResult(slot->match, result.winner, results);
+                freeSlots.push_back(std::move(slot));
+                continue;
+            }
+            const auto engineStart = perf ? PerfCounters::unattributed() : PerfCounters::Sample();
+            slot->gameManager.start(createPlayer(std::get<0>(slot->match)), createPlayer(std::get<1>(slot->match)));
+            if (perf) _enginePerf.add(PerfCounters::unattributed() - engineStart);
+            slots.push_back(std::move(slot));
+        }
+        if (slots.empty()) break;
+        std::sort(slots.begin(), slots.end(), [](const auto& slot1, const auto& slot2) {
+            return slot1->mover() < slot2->mover();
+        });
+        const auto engineStart = perf ? PerfCounters::unattributed() : PerfCounters::Sample();
+        for (auto& slot : slots) slot->gameManager.step();
+        if (perf) _enginePerf.add(PerfCounters::unattributed() - engineStart);
+        for (auto& slot : slots) {
+            if (!slot->gameManager.done()) continue;
+            const auto result = slot->gameManager.result();
+            storeMemo(slot->match, result);
+            finishGame(slot->match, result, slot->start, false);
+            recordResult(slot->match, result.winner, results);
+            freeSlots.push_back(std::move(slot));
+        }
+        slots.erase(std::remove(slots.begin(), slots.end(), nullptr), slots.end());
+        moreGames = moreGames || _serving;
+    }
+    if (!results.empty()) commitResults(results);
+}
+
+// Coordinator <-> remote worker protocol, one request or reply per line:
+//   worker: "GET <n>"                       asks for up to n games
+//   coordinator: "GAME <id1> <id2> <0|1>"   for each game, then "DONE"
+//                "WAIT"                     no game now, games of other workers may be reassigned
+//                "QUIT"                     the tournament is over
+//   worker: "RESULT <id1> <id2> <0|1> <winner> <status1> <status2> <turns> <0|1 fights threshold>
+//            <micros> <0|1 memoized>"   the game's GameResult and duration, for the coordinator's stats
+// games of a worker that disconnects before sending their results are put back in the queue
+
+void TournamentManager::runCoordinator() {
+    auto listener = Socket::listen(coordinatorAddress);
+    if (!listener.isValid()) {
+        std::cout << "ERROR: can't listen on " << coordinatorAddress << std::endl;
+        return;
+    }
+    std::vector<std::thread> connections;
+    while (!isFinished()) {
+        auto sock = listener.accept(100);
+        if (sock.isValid()) connections.emplace_back(&TournamentManager::serveWorker, this, std::move(sock));
+    }
+    for (auto& connection : connections) connection.join();
+}
+
+void TournamentManager::serveWorker(Socket sock) {
+    std::vector<Match> assigned;
+    std::vector<RatingSystem::Result> results;
+    std::string line;
+    while (sock.readLine(line)) {
+        std::istringstream iss(line);
+        std::string command;
+        iss >> command;
+        if (command == "GET") {
+            unsigned int numGames = 0;
+            iss >> numGames;
+            Match match;
+            unsigned int sent = 0;
+            std::ostringstream reply;
+            while (sent < numGames && nextMatch(match)) {
+                assigned.push_back(match);
+                reply << "GAME " << std::get<0>(match) << " " << std::get<1>(match) << " " << std::get<2>(match) << "\n";
+                sent++;
+            }
+            reply << (sent > 0 ? "DONE" : (isFinished() ? "QUIT" : "WAIT"));
+            if (!sock.sendLine(reply.str())) break;
+        } else if (command == "RESULT") {
+            Match match;
+            GameManager::GameResult result;
+            int status[2];
+            unsigned long long micros;
+            bool memoized;
+            iss >> std::get<0>(match) >> std::get<1>(match) >> std::get<2>(match) >> result.winner >> status[0] >> status[1]
+                >> result.turns >> result.fightsThreshold >> micros >> memoized;
+            const auto isStatus = [](int status) {
+                return status >= int(GameManager::PlayerStatus::Playing) && status <= int(GameManager::PlayerStatus::CantMove);
+            };
+            if (!iss || !isStatus(status[0]) || !isStatus(status[1])) {
+                std::cout << "ERROR: bad result from a worker: " << line << std::endl;
+                continue; // the game is reassigned if the worker disconnects
+            }
+            result.status[0] = GameManager::PlayerStatus(status[0]);
+            result.status[1] = GameManager::PlayerStatus(status[1]);
+            // the generation isn't sent, it's the one the game was assigned in
+            const auto it = std::find_if(assigned.begin(), assigned.end(), [&match](const Match& game) {
+                return std::get<0>(game) == std::get<0>(match) && std::get<1>(game) == std::get<1>(match) &&
+                    std::get<2>(game) == std::get<2>(match);
+            });
+            if (it == assigned.end()) continue; // not a game of this worker
+            match = *it;
+            assigned.erase(it);
+            // timed by the worker, the network isn't part of the game
+            finishGame(match, result, std::chrono::steady_clock::now() - std::chrono::microseconds(micros), memoized);
+            recordResult(match, result.winner, results);
+        }
+    }
+    if (!results.empty()) commitResults(results);
+    if (assigned.empty()) return;
+    std::cerr << "worker disconnected, reassigning " << assigned.size() << " games" << std::endl;
+    std::lock_guard<std::mutex> lock(_scoresMutex);
+    for (const auto& match : assigned) {
+        _games.push_front(match);
+        _inFlight.erase(_inFlight.find(match));
+    }
+}
+
+void TournamentManager::remoteWorkerThread() {
+    auto sock = Socket::connect(workerAddress);
+    if (!sock.isValid()) {
+        std::cout << "ERROR: can't connect to " << workerAddress << std::endl;
+        return;
+    }
+    GameManager gameManager;
+    std::string line;
+    while (sock.sendLine("GET " + std::to_string(_REMOTE_BATCH))) {
+        std::vector<Match> matches;
+        while (sock.readLine(line) && line.find("GAME ") == 0) {
+            std::istringstream iss(line.substr(5));
+            Match match;
+            iss >> std::get<0>(match) >> std::get<1>(match) >> std::get<2>(match);
+            std::get<3>(match) = _generation; // of this worker's algorithms
+            matches.push_back(match);
+        }
+        if (line == "QUIT") return;
+        if (line == "WAIT") std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        for (const auto& match : matches) {
+            const auto& id1 = std::get<0>(match);
+            const auto& id2 = std::get<1>(match);
+            if (!_algos.count(id1) || !_algos.count(id2)) {
+                std::cout << "ERROR: " << id1 << " or " << id2 << " isn't loaded by this worker" << std::endl;
+                return; // the coordinator will reassign the games
+            }
+            const auto start = std::chrono::steady_clock::now();
+            GameManager::GameResult result;
+            const auto memoized = resultOf(gameManager, match, result);
+            const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+            std::ostringstream line;
+            line << "RESULT " << id1 << " " << id2 << " " << std::get<2>(match) << " " << result.winner << " "
+                << int(result.status[0]) << " " << int(result.status[1]) << " " << result.turns << " "
+                << result.fightsThreshold << " " << duration.count() << " " << memoized;
+            if (!sock.sendLine(line.str())) return;
+        }
+    }
+}
+
+bool TournamentManager::resumeGames() {
+    Checkpoint checkpoint;
+    if (checkpointFile.empty() || !checkpoint.load(checkpointFile)) {
+        std::cout << "ERROR: can't resume from checkpoint '" << checkpointFile << "'" << std::endl;
+        return false;
+    }
+    _gamesPlayed = 0;
+    _games.clear();
+    for (const auto& score : checkpoint.scores) {
+        if (_scores.count(score.first)) _scores[score.first] = score.second;
+    }
+    unsigned int skipped = 0;
+    for (const auto& match : checkpoint.games) {
+        if (_algos.count(std::get<0>(match)) && _algos.count(std::get<1>(match))) {
+            _games.emplace_back(std::get<0>(match), std::get<1>(match), std::get<2>(match), 0);
+        } else {
+            skipped++;
+        }
+    }
+    if (skipped > 0) std::cout << "ERROR: skipping " << skipped << " games of algorithms that aren't loaded" << std::endl;
+    std::cerr << "resuming with " << _games.size() << " games left" << std::endl;
+    return true;
+}
+
+void TournamentManager::saveCheckpoint() {
+    Checkpoint checkpoint;
+    std::vector<Checkpoint::Match> finished;
+    {
+        // only the scores and the games finished since the last checkpoint are taken under the
+        // lock, the schedule is filtered and the file written without holding it
+        std::lock_guard<std::mutex> lock(_scoresMutex);
+        for (const auto& score : _scores) checkpoint.scores[score.first] = score.second;
+        finished.swap(_finishedGames);
+    }
+    // games in progress aren't finished and are played again after a resume
+    std::multiset<Checkpoint::Match> done(finished.begin(), finished.end());
+    const auto end = std::remove_if(_checkpointGames.begin(), _checkpointGames.end(), [&done](const Checkpoint::Match& match) {
+        const auto it = done.find(match);
+        if (it == done.end()) return false;
+        done.erase(it);
+        return true;
+    });
+    _checkpointGames.erase(end, _checkpointGames.end());
+    checkpoint.games = _checkpointGames;
+    if (!checkpoint.save(checkpointFile)) {
+        std::cout << "ERROR: can't write checkpoint '" << checkpointFile << "'" << std::endl;
+    }
+}
+
+void TournamentManager::checkpointThread() {
+    std::unique_lock<std::mutex> lock(_checkpointMutex);
+    while (!_checkpointCv.wait_for(lock, checkpointInterval, [this] { return _stopCheckpoints; })) {
+        saveCheckpoint();
+    }
+}
+
+static volatile std::sig_atomic_t stopServer = 0;
+
+// Serve mode: the workers wait for games instead of exiting and the main thread watches
+// path for new or rewritten libraries, which only play their own games against the
+// others. SIGINT or SIGTERM stops the server after the games in progress.
+void TournamentManager::runServer() {
+#ifndef __linux__
+    std::cout << "ERROR: -serve watches path with inotify, which needs linux" << std::endl;
+#else
+    namespace fs = std::experimental::filesystem::v1;
+    if (rated || !coordinatorAddress.empty() || !workerAddress.empty()) {
+        std::cout << "ERROR: -serve can't be combined with -rated, -coordinator or -worker" << std::endl;
+        return;
+    }
+    const int watch = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watch < 0 || inotify_add_watch(watch, path.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        std::cout << "ERROR: can't watch " << path << std::endl;
+        if (watch >= 0) close(watch);
+        return;
+    }
+    std::signal(SIGINT, [](int) { stopServer = 1; });
+    std::signal(SIGTERM, [](int) { stopServer = 1; });
+    for (const auto& file : fs::directory_iterator(path)) reloadLib(file.path().string());
+    if (_algos.size() >= 2) initGames();
+    _serving = true;
+    std::vector<std::thread> workers;
+    for (unsigned int i = 0; i < maxThreads; i++) {
+        workers.emplace_back([this, i] {
+            pinWorker(i);
+            if (interleave > 1) {
+                interleavedWorkerThread();
+            } else {
+                workerThread();
+            }
+        });
+    }
+    alignas(inotify_event) char buffer[4096];
+    bool reported = false;
+    while (!stopServer) {
+        pollfd pfd = { watch, POLLIN, 0 };
+        if (poll(&pfd, 1, 200) > 0) {
+            ssize_t length;
+            while ((length = read(watch, buffer, sizeof(buffer))) > 0) {
+                for (char* ptr = buffer; ptr < buffer + length; ) {
+                    const auto event = reinterpret_cast<const inotify_event*>(ptr);
+                    if (event->len > 0) {
+                        for (const auto& id : reloadLib((fs::path(path) / event->name).string())) {
+                            scheduleIncrementalGames(id);
+                            reported = false;
+                        }
+                    }
+                    ptr += sizeof(inotify_event) + event->len;
+                }
+            }
+        }
+        // the standings are printed whenever the scheduled games are done
+        if (!reported && isFinished()) {
+            output();
+            std::cout << std::endl;
+            reported = true;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(_scoresMutex);
+        _serving = false;
+        _games.clear();
+    }
+    _gamesCv.notify_all();
+    for (auto& worker : workers) worker.join();
+    _resultWriter.close();
+    close(watch);
+    if (!reported) output();
+    if (stats) outputStats();
+    freeSharedLibs();
+#endif
+}
+
+// loads a player library from a private copy, since dlopen of a path that is already
+// loaded returns the old version; returns the ids it registered
+std::vector<std::string> TournamentManager::reloadLib(const std::string& fname) {
+    namespace fs = std::experimental::filesystem::v1;
+    const fs::path file(fname);
+    const auto name = file.filename().string();
+    if (file.extension() != ".so" || !isValidLib(name)) return {};
+    static unsigned int numCopies = 0;
+    const auto copy = fs::temp_directory_path() /
+        ("rps_" + std::to_string(getpid()) + "_" + std::to_string(numCopies++) + "_" + name);
+    std::error_code ec;
+    fs::copy_file(file, copy, fs::copy_options::overwrite_existing, ec);
+    if (ec) {
+        std::cout << "ERROR: can't copy " << fname << ": " << ec.message() << std::endl;
+        return {};
+    }
+    const bool reloading = _libIds.count(name) > 0;
+    std::string error = checkElfHeader(copy.string());
+    LoadedLib lib;
+    if (error.empty()) lib = loadLib(copy.string(), name, error);
+    if (error.empty()) error = smokeTests({ copy.string() })[0];
+    fs::remove(copy, ec); // the mapping stays valid
+    if (!error.empty()) { // the previous version keeps playing
+        std::cout << "ERROR: rejecting " << name << ": " << error << std::endl;
+        return {};
+    }
+    // the new version plays its games again, those of the previous one are dropped
+    commitLib(lib, reloading ? _libIds[name] : std::vector<std::string>());
+    const auto ids = lib.ids();
+    _libIds[name] = ids;
+    std::cerr << (reloading ? "reloaded " : "loaded ") << name << std::endl;
+    return ids;
+}
+
+void TournamentManager::scheduleIncrementalGames(const std::string& id) {
+    std::vector<std::string> opponents;
+    {
+        std::lock_guard<std::mutex> lock(_algosMutex);
+        for (const auto& algo : _algos) {
+            if (algo.first != id) opponents.push_back(algo.first);
+        }
+    }
+    if (opponents.empty()) return;
+    std::lock_guard<std::mutex> lock(_scoresMutex);
+    // like the leftover algorithm of initGames, the new one plays all its games
+    // against the others in turn and they don't score wins in these games
+    for (unsigned int i = 0; i < _MAX_GAMES; i++) _games.emplace_back(id, opponents[i % opponents.size()], false, 0);
+    _gamesCv.notify_all();
+}
+
+void TournamentManager::outputResults() const {
+    if (!rated) return output();
+    outputRatings();
+    if (convergeTopK > 0) {
+        std::cerr << (_converged ? "converged" : "not converged") << " after " << _gamesPlayed
+            << " of " << _ratedGamesBudget << " games, saved " << _ratedGamesBudget - _gamesPlayed
+            << std::endl;
+    }
 }
 
 void TournamentManager::output() const {
@@ -138,4 +1078,123 @@ void TournamentManager::output() const {
     for (const auto& p : vec) {
         std::cout << p.first << " " << p.second << std::endl;
     }
+}
+
+void TournamentManager::outputRatings() const {
+    std::vector<std::pair<std::string, RatingSystem::Rating>> vec(
+        _ratingSystem.ratings().begin(), _ratingSystem.ratings().end());
+    std::sort(vec.begin(), vec.end(), [](const auto& p1, const auto& p2) {
+        return p1.second.rating > p2.second.rating;
+    });
+    for (const auto& p : vec) {
+        std::cout << p.first << " " << std::lround(p.second.rating)
+            << " +-" << std::lround(p.second.deviation) << std::endl;
+    }
+}
+
+void TournamentManager::outputStats() const {
+    using Status = GameManager::PlayerStatus;
+    // losses are broken down by the status that lost the game
+    std::cerr << std::left << std::setw(12) << "id" << std::right << std::setw(7) << "games" << std::setw(7) << "wins"
+        << std::setw(7) << "ties" << std::setw(10) << "avg_turns" << std::setw(11) << "threshold%"
+        << std::setw(9) << "bad_pos" << std::setw(10) << "bad_move" << std::setw(10) << "no_flags"
+        << std::setw(11) << "cant_move" << std::endl;
+    for (const auto& p : _stats) {
+        const auto& stats = p.second;
+        if (stats.games == 0) continue;
+        std::cerr << std::left << std::setw(12) << p.first << std::right << std::setw(7) << stats.games
+            << std::setw(7) << stats.wins << std::setw(7) << stats.ties
+            << std::fixed << std::setprecision(1)
+            << std::setw(10) << double(stats.turns) / stats.games
+            << std::setw(11) << 100.0 * stats.fightsThreshold / stats.games
+            << std::setw(9) << stats.losses[static_cast<int>(Status::InvalidPos)]
+            << std::setw(10) << stats.losses[static_cast<int>(Status::InvalidMove)]
+            << std::setw(10) << stats.losses[static_cast<int>(Status::NoFlags)]
+            << std::setw(11) << stats.losses[static_cast<int>(Status::CantMove)] << std::endl;
+    }
+    if (_memoLookups > 0) {
+        std::cerr << "memoized " << _memoHits << " of " << _memoLookups << " deterministic games ("
+            << std::fixed << std::setprecision(1) << 100.0 * _memoHits / _memoLookups << "% hits)" << std::endl;
+    }
+}
+
+void TournamentManager::outputMemStats() const {
+    // live is what the algorithm still held at the end, leaks included
+    std::cerr << std::left << std::setw(12) << "id" << std::right << std::setw(12) << "allocs" << std::setw(12) << "alloc_MB"
+        << std::setw(10) << "MB/sec" << std::setw(10) << "live_KB" << std::setw(10) << "peak_KB"
+        << std::setw(10) << "forfeits" << std::endl;
+    for (const auto& p : _stats) {
+        const auto slot = AllocAccounting::slot(p.first);
+        if (slot == AllocAccounting::NO_SLOT) {
+            std::cerr << std::left << std::setw(12) << p.first << std::right << std::setw(12) << "n/a" << std::setw(12) << "n/a"
+                << std::setw(10) << "n/a" << std::setw(10) << "n/a" << std::setw(10) << "n/a" << std::setw(10) << "n/a" << std::endl;
+            continue;
+        }
+        const auto& counters = AllocAccounting::counters(slot);
+        if (counters.allocs == 0) continue;
+        std::cerr << std::left << std::setw(12) << p.first << std::right << std::setw(12) << counters.allocs
+            << std::fixed << std::setprecision(1)
+            << std::setw(12) << counters.bytes / 1e6
+            << std::setw(10) << (_workSeconds > 0 ? counters.bytes / 1e6 / _workSeconds : 0.0)
+            << std::setw(10) << counters.live / 1e3
+            << std::setw(10) << counters.peak / 1e3
+            << std::setw(10) << counters.forfeits << std::endl;
+    }
+}
+
+static void outputPerfRow(const std::string& name, const PerfCounters::Totals& totals) {
+    using Event = PerfCounters::Event;
+    const double instructions = totals.counts[Event::Instructions];
+    const double cycles = totals.counts[Event::Cycles];
+    std::cerr << std::left << std::setw(12) << name << std::right << std::setw(10) << totals.samples
+        << std::fixed << std::setprecision(1)
+        << std::setw(12) << instructions / 1e6 << std::setw(12) << cycles / 1e6
+        << std::setprecision(2) << std::setw(6) << (cycles > 0 ? instructions / cycles : 0.0)
+        << std::setw(16) << (instructions > 0 ? 1e3 * totals.counts[Event::CacheMisses] / instructions : 0.0)
+        << std::setw(17) << (instructions > 0 ? 1e3 * totals.counts[Event::BranchMisses] / instructions : 0.0) << std::endl;
+}
+
+void TournamentManager::outputPerf() const {
+    // samples are calls for an algorithm, the engine's are games (or interleaved passes)
+    std::cerr << std::left << std::setw(12) << "id" << std::right << std::setw(10) << "samples" << std::setw(12) << "M_instr"
+        << std::setw(12) << "M_cycles" << std::setw(6) << "IPC" << std::setw(16) << "cache_miss/Kins"
+        << std::setw(17) << "branch_miss/Kins" << std::endl;
+    for (const auto& p : _stats) {
+        if (p.second.perf.samples > 0) outputPerfRow(p.first, p.second.perf);
+    }
+    outputPerfRow("(engine)", _enginePerf);
+}
+
+void TournamentManager::runBenchmark() {
+    for (unsigned int i = 0; i < benchAlgos; i++) {
+        const auto moveCost = benchMoveCost;
+        registerAlgorithm("synthetic_" + std::to_string(i), [moveCost] {
+            return std::make_unique<SyntheticPlayerAlgorithm>(moveCost);
+        });
+    }
+    if (_algos.size() < 2) return; // not enough players
+    // sweep the thread count in powers of two up to maxThreads
+    std::vector<unsigned int> sweep;
+    for (unsigned int numThreads = 1; numThreads < maxThreads; numThreads *= 2) sweep.push_back(numThreads);
+    sweep.push_back(maxThreads);
+    double baseSeconds = 0;
+    std::cout << "threads,wall_ms,games,games_per_sec,lock_wait_ms,speedup" << std::endl;
+    for (const auto numThreads : sweep) {
+        for (auto& score : _scores) score.second = 0;
+        _lockWaitNs = 0;
+        initGames();
+        const auto start = std::chrono::steady_clock::now();
+        runWorkers(numThreads);
+        const unsigned int numGames = _gamesPlayed;
+        const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (baseSeconds == 0) baseSeconds = seconds;
+        std::cout << std::fixed << std::setprecision(3)
+            << numThreads << ","
+            << seconds * 1e3 << ","
+            << numGames << ","
+            << numGames / seconds << ","
+            << _lockWaitNs / 1e6 << ","
+            << baseSeconds / seconds << std::endl;
+    }
+    _algos.clear();
 }
\ No newline at end of file
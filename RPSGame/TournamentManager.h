@@ -1,14 +1,28 @@
 #pragma once
 
 #include <functional>
+#include <chrono>
 #include <string>
 #include <thread>
 #include <atomic>
+#include <random>
 #include <mutex>
+#include <condition_variable>
 #include <tuple>
 #include <deque>
+#include <set>
+#include <unordered_map>
 #include <map>
 #include "PlayerAlgorithm.h"
+#include "AlgorithmRegistration.h"
+#include "GameManager.h"
+#include "RatingSystem.h"
+#include "Socket.h"
+#include "Topology.h"
+#include "ResultWriter.h"
+#include "Profile.h"
+#include "Checkpoint.h"
+#include "PerfCounters.h"
 
 
 class TournamentManager {
@@ -16,23 +30,154 @@ public:
     static TournamentManager& getTournamentManager() { return _singleton; }
     TournamentManager(const TournamentManager&) = delete;
     TournamentManager& operator=(const TournamentManager&) = delete;
-    void registerAlgorithm(std::string id, std::function<std::unique_ptr<PlayerAlgorithm>()> factoryMethod);
+    void registerAlgorithm(std::string id, std::function<std::unique_ptr<PlayerAlgorithm>()> factoryMethod,
+        AlgorithmInfo info = AlgorithmInfo());
     void run();
-    unsigned int maxThreads = 4;
+    int runSmokeGames();
+    unsigned int maxThreads = 4; // 0 for one thread per available cpu
+    std::string pin; // "cores" or "nodes" to pin each worker there, empty to leave placement to the os
     std::string path = "./";
+    bool rated = false; // rank by Glicko-2 ratings and pair the least certain players adaptively
+    unsigned int convergeTopK = 0; // with rated, stop once the top k ordering is stable, 0 to play all games
+    std::string coordinatorAddress; // serve the games to remote workers instead of playing them
+    std::string workerAddress; // play the games of the coordinator at this address
+    unsigned int benchAlgos = 0; // number of synthetic algorithms, 0 for a regular tournament
+    std::chrono::nanoseconds benchMoveCost = std::chrono::microseconds(10);
+    std::string checkpointFile; // periodically save the tournament state here, empty to disable
+    std::chrono::milliseconds checkpointInterval{ 10000 };
+    bool resume = false; // continue the tournament saved in checkpointFile
+    std::string resultsFile; // stream a record per game here, empty to disable
+    ResultWriter::Format resultsFormat = ResultWriter::Format::Csv;
+    unsigned int interleave = 0; // games each worker advances together, 0 or 1 plays them one by one
+    bool stats = false; // print how each algorithm's games ended
+    bool serve = false; // keep running, load new or updated libraries from path and play their games
+    std::string schedule; // "ljf" to play the most expensive games first, empty for the drawing order
+    std::string profileFile = "rps.profile"; // per algorithm timings, updated by every run, the ljf schedule estimates costs from
+    bool memStats = false; // print the allocations of each algorithm, needs an ALLOC_ACCOUNTING build
+    std::size_t memCap = 0; // bytes an algorithm may keep live on a worker before forfeiting, 0 for no cap
+    bool perf = false; // count instructions, cycles and misses of each algorithm's calls and of the engine
+    std::string executable; // argv[0], where /proc/self/exe isn't available
+    std::string smokeLib; // the library a -smoke process checks, see smokeTests
 private:
+    // per algorithm outcome counters, updated by the workers without locking
+    struct AlgorithmStats {
+        std::atomic_ullong games{ 0 };
+        std::atomic_ullong wins{ 0 };
+        std::atomic_ullong ties{ 0 };
+        std::atomic_ullong turns{ 0 };
+        std::atomic_ullong fightsThreshold{ 0 };
+        std::atomic_ullong losses[5]{}; // by the PlayerStatus that lost the game
+        std::atomic_ullong playedGames{ 0 }; // not memoized, the ones micros counts
+        std::atomic_ullong micros{ 0 };
+        PerfCounters::Totals perf; // of the algorithm's calls, a sample per call
+        void add(const GameManager::GameResult& result, int player);
+        void reset();
+    };
+    // id1, id2, whether id2 may score a win, and the generation it was dispatched in
+    using Match = std::tuple<std::string, std::string, bool, unsigned int>;
+    // a library's registrations, held back until the library passed its checks
+    struct LoadedLib {
+        struct Algorithm {
+            std::string id;
+            std::function<std::unique_ptr<PlayerAlgorithm>()> factory;
+            AlgorithmInfo info;
+        };
+        std::shared_ptr<void> handle; // null for an algorithm linked into the executable
+        std::vector<Algorithm> algos;
+        std::vector<std::string> ids() const;
+    };
     TournamentManager() = default;
     bool isValidLib(const std::string fname) const;
     void loadSharedLibs();
+    LoadedLib loadLib(const std::string& fname, const std::string& name, std::string& error);
+    void commitLib(const LoadedLib& lib, const std::vector<std::string>& replaced);
+    bool isStale(const Match& match) const;
+    std::vector<std::string> smokeTests(const std::vector<std::string>& fnames);
     void freeSharedLibs();
+    std::shared_ptr<PlayerAlgorithm> createPlayer(const std::string& id);
+    void runServer();
+    std::vector<std::string> reloadLib(const std::string& fname);
+    void scheduleIncrementalGames(const std::string& id);
     void initGames();
+    void initRatedGames();
+    bool scheduleRatedGames();
+    void commitResults(std::vector<RatingSystem::Result>& results);
+    bool nextMatch(Match& match, bool wait = true);
+    void recordResult(const Match& match, int winner, std::vector<RatingSystem::Result>& results);
+    bool isFinished();
+    void runWorkers(unsigned int numThreads);
+    void pinWorker(unsigned int worker);
+    void outputNodeThroughput(unsigned int numThreads, double seconds) const;
+    int playGame(GameManager& gameManager, const Match& match);
+    bool resultOf(GameManager& gameManager, const Match& match, GameManager::GameResult& result); // true when memoized
+    void finishGame(const Match& match, const GameManager::GameResult& result, std::chrono::steady_clock::time_point start,
+        bool memoized);
+    void orderGames();
+    void outputMakespan(unsigned int numThreads, double seconds) const;
+    void saveProfile();
+    bool lookupMemo(const Match& match, GameManager::GameResult& result);
+    void storeMemo(const Match& match, const GameManager::GameResult& result);
     void workerThread();
+    void interleavedWorkerThread();
+    void runCoordinator();
+    void serveWorker(Socket sock);
+    void remoteWorkerThread();
+    void outputResults() const;
     void output() const;
+    void outputRatings() const;
+    void outputStats() const;
+    void outputMemStats() const;
+    void outputPerf() const;
+    void runBenchmark();
+    bool resumeGames();
+    void saveCheckpoint();
+    void checkpointThread();
     static TournamentManager _singleton;
+    static thread_local LoadedLib* _loadingLib; // registration runs inside dlopen, on the thread loading the library
     std::map<std::string, std::function<std::unique_ptr<PlayerAlgorithm>()>> _algos;
     std::map<std::string, std::atomic_uint> _scores;
-    std::deque<std::tuple<std::string, std::string, bool>> _games;
-    std::vector<void *> _libs;
+    std::set<std::string> _deterministic; // ids registered as deterministic
+    std::unordered_map<std::string, GameManager::GameResult> _memo; // by "id1 id2" of deterministic pairs
+    std::mutex _memoMutex;
+    std::atomic_ullong _memoLookups{ 0 };
+    std::atomic_ullong _memoHits{ 0 };
+    std::map<std::string, AlgorithmStats> _stats; // entries are never erased, workers keep references
+    std::deque<Match> _games;
+    std::multiset<Match> _inFlight; // games taken from _games whose result wasn't recorded yet
+    std::vector<Checkpoint::Match> _checkpointGames; // not finished at the last checkpoint, the checkpoint thread's
+    std::vector<Checkpoint::Match> _finishedGames; // recorded since the last checkpoint, under _scoresMutex
+    std::map<std::string, std::shared_ptr<void>> _algoLibs; // the library each algorithm came from
+    std::map<std::string, std::vector<std::string>> _libIds; // ids each library file registered
+    // generation each algorithm's current version was registered in, a game dispatched in an
+    // earlier one played a replaced version and its result is discarded
+    std::map<std::string, unsigned int> _generations;
+    std::atomic_uint _generation{ 0 };
+    std::mutex _algosMutex;
+    std::atomic_bool _serving{ false };
+    std::condition_variable _gamesCv; // signaled when games are added to a serving tournament
     std::mutex _scoresMutex;
+    std::atomic<long long> _lockWaitNs{ 0 }; // workers waited for the scores lock, to take a game or record one
+    std::atomic_uint _gamesPlayed{ 0 };
+    RatingSystem _ratingSystem;
+    std::vector<RatingSystem::Result> _pendingResults; // of the current rating period
+    std::mutex _ratingsMutex;
+    unsigned int _ratedGamesLeft = 0;
+    unsigned int _ratedGamesBudget = 0;
+    std::atomic_bool _converged{ false };
+    std::mt19937 _rg{ std::random_device{}() };
+    ResultWriter _resultWriter;
+    Topology _topology;
+    std::vector<unsigned int> _nodeGames; // games played by the workers of each node
+    Profile _profile;
+    std::atomic_ullong _gameMicros{ 0 }; // total duration of the games of this run
+    std::atomic_ullong _longestGameMicros{ 0 };
+    double _workSeconds = 0; // of the last runWorkers
+    PerfCounters::Totals _enginePerf; // of the games minus the players' calls, a sample per game
+    std::mutex _checkpointMutex;
+    std::condition_variable _checkpointCv;
+    bool _stopCheckpoints = false;
     const unsigned int _MAX_GAMES = 30;
+    const unsigned int _RESULTS_BATCH = 8; // results a worker collects before committing them
+    const unsigned int _REMOTE_BATCH = 4; // games a remote worker asks for at once
+    const std::chrono::milliseconds _SMOKE_TIMEOUT{ 5000 }; // for the preflight games of a library
 };
\ No newline at end of file
@@ -0,0 +1,332 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "GameManager.h"
+#include "GameContainers.h"
+#include "AutoPlayerAlgorithm.h"
+#include "PlayerAlgorithmV2.h"
+#include "Piece.h"
+#include "BoardEval.h"
+
+// All results are printed as "benchmark,metric,value" CSV rows so runs can be diffed and tracked
+
+
+static volatile long long sink = 0;
+
+static void report(const std::string& benchmark, const std::string& metric, double value) {
+    std::cout << benchmark << "," << metric << "," << value << std::endl;
+}
+
+// a correctness check failing makes the timings meaningless, so the run fails too
+static void requireNoMismatches(const std::string& benchmark, int mismatches) {
+    report(benchmark, "mismatches", mismatches);
+    if (mismatches == 0) return;
+    std::cout << "ERROR: " << benchmark << " has " << mismatches << " mismatches" << std::endl;
+    std::exit(1);
+}
+
+// runs func until enough time passed and reports the mean ns per call
+template<class FUNC>
+static void measure(const std::string& benchmark, FUNC func) {
+    using clock = std::chrono::steady_clock;
+    const auto minDuration = std::chrono::milliseconds(200);
+    long long calls = 0;
+    const auto start = clock::now();
+    auto elapsed = clock::duration::zero();
+    do {
+        for (int i = 0; i < 64; i++) func();
+        calls += 64;
+        elapsed = clock::now() - start;
+    } while (elapsed < minDuration);
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    report(benchmark, "ns_per_op", double(ns) / calls);
+}
+
+// plays a fixed script: a flag and a rock moving back and forth in one of the middle rows
+// (which AutoPlayerAlgorithm never positions on), so games against a passive opponent run
+// until the fights threshold and cost is dominated by the engine
+class ScriptedPlayerAlgorithm : public PlayerAlgorithm {
+public:
+    void getInitialPositions(int player, std::vector<std::unique_ptr<PiecePosition>>& positions) override {
+        _row = player == 1 ? 5 : 6;
+        _col = 2;
+        positions.push_back(std::make_unique<PiecePositionImpl>(_row, 1, 'F'));
+        positions.push_back(std::make_unique<PiecePositionImpl>(_row, _col, 'R'));
+    }
+    void notifyOnInitialBoard(const Board&, const std::vector<std::unique_ptr<FightInfo>>&) override {}
+    void notifyOnOpponentMove(const Move&) override {}
+    void notifyFightResult(const FightInfo&) override {}
+    std::unique_ptr<Move> getMove() override {
+        auto to = _col == 2 ? 3 : 2;
+        auto move = std::make_unique<GameMove>(_row, _col, _row, to);
+        _col = to;
+        return move;
+    }
+    std::unique_ptr<JokerChange> getJokerChange() override { return nullptr; }
+private:
+    int _row = 5;
+    int _col = 2;
+};
+
+// forwards every call and counts the moves it was asked for
+class CountingPlayerAlgorithm : public PlayerAlgorithm {
+public:
+    CountingPlayerAlgorithm(std::unique_ptr<PlayerAlgorithm> algo, long long& numMoves) :
+        _algo(std::move(algo)), _numMoves(numMoves) {}
+    void getInitialPositions(int player, std::vector<std::unique_ptr<PiecePosition>>& positions) override {
+        _algo->getInitialPositions(player, positions);
+    }
+    void notifyOnInitialBoard(const Board& b, const std::vector<std::unique_ptr<FightInfo>>& fights) override {
+        _algo->notifyOnInitialBoard(b, fights);
+    }
+    void notifyOnOpponentMove(const Move& move) override { _algo->notifyOnOpponentMove(move); }
+    void notifyFightResult(const FightInfo& fightInfo) override { _algo->notifyFightResult(fightInfo); }
+    std::unique_ptr<Move> getMove() override {
+        _numMoves++;
+        return _algo->getMove();
+    }
+    std::unique_ptr<JokerChange> getJokerChange() override { return _algo->getJokerChange(); }
+private:
+    std::unique_ptr<PlayerAlgorithm> _algo;
+    long long& _numMoves;
+};
+
+// CountingPlayerAlgorithm for players of the batched interface, so the referee uses it
+class CountingPlayerAlgorithmV2 : public PlayerAlgorithmV2 {
+public:
+    CountingPlayerAlgorithmV2(std::unique_ptr<PlayerAlgorithmV2> algo, long long& numMoves) :
+        _algo(std::move(algo)), _numMoves(numMoves) {}
+    void getInitialPositions(int player, std::vector<std::unique_ptr<PiecePosition>>& positions) override {
+        _algo->getInitialPositions(player, positions);
+    }
+    void notifyOnInitialBoard(const Board& b, const std::vector<std::unique_ptr<FightInfo>>& fights) override {
+        _algo->notifyOnInitialBoard(b, fights);
+    }
+    void notifyOnOpponentMove(const Move& move) override { _algo->notifyOnOpponentMove(move); }
+    void notifyFightResult(const FightInfo& fightInfo) override { _algo->notifyFightResult(fightInfo); }
+    std::unique_ptr<Move> getMove() override {
+        _numMoves++;
+        return _algo->getMove();
+    }
+    std::unique_ptr<JokerChange> getJokerChange() override { return _algo->getJokerChange(); }
+    void playTurn(const TurnEvent* events, std::size_t numEvents, TurnReply& reply) override {
+        _numMoves++;
+        _algo->playTurn(events, numEvents, reply);
+    }
+private:
+    std::unique_ptr<PlayerAlgorithmV2> _algo;
+    long long& _numMoves;
+};
+
+class Benchmark {
+public:
+    template<class ALGO1, class ALGO2, class COUNTING1 = CountingPlayerAlgorithm>
+    static void games(const std::string& benchmark) {
+        using clock = std::chrono::steady_clock;
+        const auto minDuration = std::chrono::milliseconds(500);
+        GameManager gameManager;
+        long long numGames = 0;
+        long long numTurns = 0;
+        const auto start = clock::now();
+        auto elapsed = clock::duration::zero();
+        do {
+            auto algo1 = std::make_shared<COUNTING1>(std::make_unique<ALGO1>(), numTurns);
+            auto algo2 = std::make_shared<CountingPlayerAlgorithm>(std::make_unique<ALGO2>(), numTurns);
+            sink += gameManager.playRound(algo1, algo2).winner;
+            numGames++;
+            elapsed = clock::now() - start;
+        } while (elapsed < minDuration);
+        const auto seconds = std::chrono::duration<double>(elapsed).count();
+        report(benchmark, "games_per_sec", numGames / seconds);
+        report(benchmark, "turns_per_sec", numTurns / seconds);
+        report(benchmark, "turns_per_game", double(numTurns) / numGames);
+    }
+    static void pieces() {
+        const char types[] = { 'F', 'R', 'P', 'S', 'B' };
+        std::vector<Piece> pieces;
+        for (const auto type : types) pieces.emplace_back(1, type);
+        pieces.emplace_back(1, 'J', 'R');
+        measure("Piece::canKill", [&] {
+            for (const auto& piece1 : pieces) {
+                for (const auto& piece2 : pieces) sink += piece1.canKill(piece2);
+            }
+        });
+    }
+    // the checks the referee makes every turn, which are all GameState's
+    static void rules() {
+        GameState state;
+        const GamePoint flag(1, 1);
+        const GamePoint from(5, 5);
+        const GamePoint to(5, 6);
+        const GamePoint joker(5, 4);
+        state.place(flag, Piece(1, 'F'));
+        state.place(from, Piece(1, 'R'));
+        state.place(to, Piece(2, 'S'));
+        state.place(joker, Piece(1, 'J', 'R'));
+        measure("GameState::isValidMove", [&] { sink += state.isValidMove(from, to, 1); });
+        measure("GameState::isValidJokerChange", [&] { sink += state.isValidJokerChange(joker, 'S', 1); });
+        measure("Piece::isValid", [&] { sink += Piece::isValid('J', 'B'); });
+        measure("GameState::isPlaying", [&] { sink += state.isPlaying(1); });
+    }
+    // a move onto each kind of square, taken back right away: the fights resolve through
+    // Piece::canKill and update both sides' counters, which a move to an empty square skips
+    static void fights() {
+        const GamePoint from(5, 5);
+        const GamePoint to(5, 6);
+        const struct { const char* name; Piece attacker; Piece defender; } cases[] = {
+            { "empty", Piece(1, 'R'), Piece() },
+            { "win", Piece(1, 'R'), Piece(2, 'S') },
+            { "loss", Piece(1, 'R'), Piece(2, 'P') },
+            { "tie", Piece(1, 'R'), Piece(2, 'R') },
+            { "bomb", Piece(1, 'R'), Piece(2, 'B') },
+            { "joker", Piece(1, 'J', 'R'), Piece(2, 'J', 'S') },
+        };
+        for (const auto& fight : cases) {
+            GameState state;
+            state.place(GamePoint(1, 1), Piece(1, 'F'));
+            state.place(GamePoint(10, 10), Piece(2, 'F'));
+            state.place(from, fight.attacker);
+            if (fight.defender.getPlayer() != 0) state.place(to, fight.defender);
+            measure(std::string("GameState::makeMove+unmakeMove/") + fight.name, [&] {
+                sink += state.makeMove(from, to);
+                state.unmakeMove();
+            });
+        }
+    }
+    // random games played forward and taken back: every unmakeMove must restore the state from
+    // before its move exactly, and unwinding a whole game the state it started from
+    static void state() {
+        std::mt19937 rg(1);
+        const char types[] = { 'R', 'P', 'S', 'B', 'F', 'J' };
+        const char reps[] = { 'R', 'P', 'S', 'B' };
+        auto random = [&rg](int min, int max) { return std::uniform_int_distribution<int>(min, max)(rg); };
+        GameState state;
+        int mismatches = 0;
+        for (int game = 0; game < 64; game++) {
+            state.clear();
+            for (int i = 0; i < 40; i++) {
+                const auto type = types[random(0, 5)];
+                state.place(GamePoint(random(1, GameBoard<Piece>::N), random(1, GameBoard<Piece>::M)),
+                    Piece(i % 2 + 1, type, type == 'J' ? reps[random(0, 3)] : ' '));
+            }
+            const auto initial = snapshot(state);
+            std::vector<std::string> before;
+            // every other change is taken back and checked right away, then made again
+            auto play = [&](const std::function<void()>& change) {
+                before.push_back(snapshot(state));
+                change();
+                if (random(0, 1) == 0) return;
+                state.unmakeMove();
+                mismatches += snapshot(state) != before.back();
+                change();
+            };
+            for (int turn = 0; turn < 200; turn++) {
+                const auto player = turn % 2 + 1;
+                std::vector<std::pair<GamePoint, GamePoint>> moves;
+                std::vector<GamePoint> jokers;
+                for (int x = 1; x <= GameBoard<Piece>::N; x++) {
+                    for (int y = 1; y <= GameBoard<Piece>::M; y++) {
+                        const GamePoint from(x, y);
+                        if (state.board()[from].player != player) continue;
+                        if (state.board()[from].piece.getUnderlyingType() == 'J') jokers.push_back(from);
+                        for (int dx = -1; dx <= 1; dx++) {
+                            for (int dy = -1; dy <= 1; dy++) {
+                                const GamePoint to(x + dx, y + dy);
+                                if (state.isValidMove(from, to, player)) moves.emplace_back(from, to);
+                            }
+                        }
+                    }
+                }
+                if (moves.empty()) break;
+                const auto move = moves[random(0, moves.size() - 1)];
+                play([&] { state.makeMove(move.first, move.second); });
+                if (jokers.empty() || random(0, 3) != 0) continue;
+                const auto joker = jokers[random(0, jokers.size() - 1)];
+                const auto rep = reps[random(0, 3)];
+                if (state.isValidJokerChange(joker, rep, player)) play([&] { state.changeJoker(joker, rep); });
+            }
+            while (!before.empty()) {
+                state.unmakeMove();
+                mismatches += snapshot(state) != before.back();
+                before.pop_back();
+            }
+            mismatches += snapshot(state) != initial;
+        }
+        requireNoMismatches("GameState::unmakeMove", mismatches);
+    }
+    // the whole state as a string, for comparing two of them
+    static std::string snapshot(const GameState& state) {
+        std::string result;
+        for (int x = 1; x <= GameBoard<Piece>::N; x++) {
+            for (int y = 1; y <= GameBoard<Piece>::M; y++) {
+                const auto& entry = state.board()[GamePoint(x, y)];
+                result += { char('0' + entry.player), entry.piece.getUnderlyingType(), entry.piece.getJokerType() };
+            }
+        }
+        for (int player = 1; player <= 2; player++) {
+            const auto& side = state.side(player);
+            for (const auto num : side.numPieces) result += std::to_string(num) + ",";
+            result += std::to_string(side.numFlags) + "," + std::to_string(side.numMovable) + ";";
+        }
+        return result + std::to_string(state.numFights());
+    }
+    static void eval() {
+        // random boards of 40 to 80 pieces, a quarter of them unknown
+        std::mt19937 rg(1);
+        const uint8_t bits[] = { BoardEval::OurR, BoardEval::OurP, BoardEval::OurS, BoardEval::OurOther,
+            BoardEval::TheirR, BoardEval::TheirP, BoardEval::TheirS, BoardEval::TheirUnknown, BoardEval::TheirUnknown };
+        std::vector<BoardEval::Board> boards(64);
+        for (auto& board : boards) {
+            const auto numPieces = std::uniform_int_distribution<int>(40, 80)(rg);
+            for (int i = 0; i < numPieces; i++) {
+                const auto square = BoardEval::Board::square(std::uniform_int_distribution<int>(1, 10)(rg),
+                    std::uniform_int_distribution<int>(1, 10)(rg));
+                board[square] = bits[std::uniform_int_distribution<int>(0, 8)(rg)];
+                if (board[square] == BoardEval::OurOther && board.flag < 0) board.flag = square;
+            }
+        }
+        const std::pair<BoardEval::Variant, std::string> variants[] = {
+            { BoardEval::Variant::Scalar, "scalar" }, { BoardEval::Variant::Sse2, "sse2" }, { BoardEval::Variant::Avx2, "avx2" } };
+        // a vector variant must score every board exactly like the scalar one
+        for (const auto& variant : variants) {
+            if (variant.first > BoardEval::best()) continue;
+            int mismatches = 0;
+            for (const auto& board : boards) {
+                mismatches += BoardEval::evaluate(board, variant.first) != BoardEval::evaluate(board, BoardEval::Variant::Scalar);
+            }
+            requireNoMismatches("BoardEval::evaluate/" + variant.second, mismatches);
+            unsigned int i = 0;
+            measure("BoardEval::evaluate/" + variant.second, [&] { sink += BoardEval::evaluate(boards[i++ % boards.size()], variant.first); });
+        }
+    }
+    static void board() {
+        GameBoard<Piece> board;
+        const GamePoint pos(3, 7);
+        board[pos] = { Piece(1, 'R'), 1 };
+        measure("GameBoard::operator[](Point)", [&] { sink += board[pos].player; });
+        measure("GameBoard::operator[](pair)", [&] { sink += board[{ 2, 6 }].player; });
+        measure("GameBoard::getPlayer", [&] { sink += board.getPlayer(pos); });
+        measure("GameBoard::isValid", [&] { sink += board.isValid(pos); });
+        measure("GameBoard::clear", [&] { board.clear(); });
+    }
+};
+
+int main() {
+    std::cout << "benchmark,metric,value" << std::endl;
+    Benchmark::games<ScriptedPlayerAlgorithm, ScriptedPlayerAlgorithm>("playRound/Scripted-Scripted");
+    Benchmark::games<AutoPlayerAlgorithm, ScriptedPlayerAlgorithm>("playRound/Auto-Scripted");
+    Benchmark::games<AutoPlayerAlgorithm, ScriptedPlayerAlgorithm, CountingPlayerAlgorithmV2>("playRound/AutoV2-Scripted");
+    Benchmark::games<AutoPlayerAlgorithm, AutoPlayerAlgorithm>("playRound/Auto-Auto");
+    Benchmark::pieces();
+    Benchmark::rules();
+    Benchmark::fights();
+    Benchmark::state();
+    Benchmark::board();
+    Benchmark::eval();
+    return 0;
+}
@@ -1,7 +1,9 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <chrono>
 #include "TournamentManager.h"
+#include "Log.h"
 
 
 int main(int argc, char *argv[]) {
@@ -9,12 +11,61 @@ int main(int argc, char *argv[]) {
     std::vector<std::string> vec(argv + 1, argv + argc);
     vec.push_back(""); // to make is possible to itetate until vec.size() - 1
     for (unsigned int i = 0; i < vec.size() - 1; i++) {
-        if (vec[i] == "-threads") {
-            manager.maxThreads = std::stoul(vec[i + 1]);
+        if (vec[i] == "-rated") {
+            manager.rated = true;
+        } else if (vec[i] == "-converge") {
+            manager.rated = true;
+            manager.convergeTopK = std::stoul(vec[i + 1]);
+        } else if (vec[i] == "-threads") {
+            manager.maxThreads = vec[i + 1] == "auto" ? 0 : std::stoul(vec[i + 1]);
+        } else if (vec[i] == "-pin") {
+            manager.pin = vec[i + 1];
         } else if (vec[i] == "-path") {
             manager.path = vec[i + 1];
+        } else if (vec[i] == "-bench") {
+            manager.benchAlgos = std::stoul(vec[i + 1]);
+        } else if (vec[i] == "-coordinator") {
+            manager.coordinatorAddress = vec[i + 1];
+        } else if (vec[i] == "-worker") {
+            manager.workerAddress = vec[i + 1];
+        } else if (vec[i] == "-log") {
+            Log::setLevel(Log::parseLevel(vec[i + 1]));
+        } else if (vec[i] == "-checkpoint") {
+            manager.checkpointFile = vec[i + 1];
+        } else if (vec[i] == "-checkpoint_every") {
+            manager.checkpointInterval = std::chrono::milliseconds(std::stoul(vec[i + 1]));
+        } else if (vec[i] == "-results") {
+            manager.resultsFile = vec[i + 1];
+        } else if (vec[i] == "-format") {
+            if (!ResultWriter::parseFormat(vec[i + 1], manager.resultsFormat)) {
+                std::cout << "ERROR: unknown -format " << vec[i + 1] << ", expected csv, json or bin" << std::endl;
+            }
+        } else if (vec[i] == "-interleave") {
+            manager.interleave = std::stoul(vec[i + 1]);
+        } else if (vec[i] == "-schedule") {
+            manager.schedule = vec[i + 1];
+        } else if (vec[i] == "-profile") {
+            manager.profileFile = vec[i + 1];
+        } else if (vec[i] == "-memstats") {
+            manager.memStats = true;
+        } else if (vec[i] == "-memcap") {
+            manager.memCap = std::stoull(vec[i + 1]) << 20; // MB
+        } else if (vec[i] == "-perf") {
+            manager.perf = true;
+        } else if (vec[i] == "-stats") {
+            manager.stats = true;
+        } else if (vec[i] == "-serve") {
+            manager.serve = true;
+        } else if (vec[i] == "-resume") {
+            manager.resume = true;
+        } else if (vec[i] == "-smoke") {
+            manager.smokeLib = vec[i + 1];
+        } else if (vec[i] == "-move_cost") {
+            manager.benchMoveCost = std::chrono::nanoseconds(std::stoul(vec[i + 1]));
         }
     }
+    manager.executable = argv[0];
+    if (!manager.smokeLib.empty()) return manager.runSmokeGames();
     manager.run();
     return 0;
 }
\ No newline at end of file
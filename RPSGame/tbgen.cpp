@@ -0,0 +1,21 @@
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <thread>
+#include "Tablebase.h"
+
+// usage: tbgen [file [threads]], builds the endgame tablebase AutoPlayerAlgorithm reads from $RPS_TABLEBASE
+int main(int argc, char *argv[]) {
+    const std::string fname = argc > 1 ? argv[1] : "rps.tablebase";
+    const unsigned int numThreads = argc > 2 ? std::stoul(argv[2]) : std::thread::hardware_concurrency();
+    const auto start = std::chrono::steady_clock::now();
+    const auto size = Tablebase::generate(fname, numThreads);
+    if (size == 0) {
+        std::cout << "ERROR: can't write tablebase '" << fname << "'" << std::endl;
+        return 1;
+    }
+    const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << "generated " << fname << " with " << numThreads << " threads in " << seconds << " sec, "
+        << size << " bytes (" << 100 * size / Tablebase::SIZE << "% of the values)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,187 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <cmath>
+#include <algorithm>
+#include <dlfcn.h>
+#include <experimental/filesystem>
+#include "AlgorithmRegistration.h"
+#include "AutoPlayerAlgorithm.h"
+#include "AutoParams.h"
+#include "GameManager.h"
+
+namespace fs = std::experimental::filesystem;
+
+// Tunes the AutoParams of AutoPlayerAlgorithm by self-play with SPSA: every iteration perturbs
+// all the parameters at once by a random sign each, plays both perturbed players against every
+// opponent and against each other, and steps along the difference of their scores. Parameters
+// are tuned in units of their AutoParams::Field step, so a single gain fits all of them.
+
+// the player libraries register here instead of in a tournament, and so does AutoPlayerAlgorithm
+// with the parameters of $RPS_PARAMS, as a fixed opponent
+static std::map<std::string, std::function<std::unique_ptr<PlayerAlgorithm>()>>& opponents() {
+    static std::map<std::string, std::function<std::unique_ptr<PlayerAlgorithm>()>> opponents;
+    return opponents;
+}
+
+AlgorithmRegistration::AlgorithmRegistration(std::string id, std::function<std::unique_ptr<PlayerAlgorithm>()> factoryMethod) {
+    opponents()[id] = factoryMethod;
+}
+
+AlgorithmRegistration::AlgorithmRegistration(std::string id, std::function<std::unique_ptr<PlayerAlgorithm>()> factoryMethod,
+        AlgorithmInfo) {
+    opponents()[id] = factoryMethod;
+}
+
+// the usual SPSA gain sequences, a_k = A / (k + 1 + STABILITY)^ALPHA and c_k = C / (k + 1)^GAMMA
+const double ALPHA = 0.602;
+const double GAMMA = 0.101;
+const double GAIN_A = 2; // steps per unit of score difference, at first
+const double GAIN_C = 1; // perturbation in steps, at first
+
+struct Tuner {
+    std::vector<std::function<std::unique_ptr<PlayerAlgorithm>()>> pool;
+    unsigned int gamesPerOpponent = 4; // by each perturbed player, alternating sides
+    unsigned int numThreads = std::max(1u, std::thread::hardware_concurrency()); // which may be 0 when unknown
+    std::atomic_ullong totalGames{ 0 };
+
+    // the mean result of the games of plus and of minus, 1 for winning all and -1 for losing all
+    std::pair<double, double> play(const AutoParams& plus, const AutoParams& minus) {
+        // a game is an opponent (the other player for the last ones) and a side
+        const unsigned int poolGames = 2 * pool.size() * gamesPerOpponent;
+        const unsigned int numGames = poolGames + 2 * gamesPerOpponent;
+        std::atomic_uint next{ 0 };
+        std::atomic_int plusScore{ 0 };
+        std::atomic_int minusScore{ 0 };
+        auto worker = [&] {
+            GameManager gameManager;
+            for (unsigned int game = next++; game < numGames; game = next++) {
+                std::shared_ptr<PlayerAlgorithm> tuned;
+                std::shared_ptr<PlayerAlgorithm> other;
+                bool isPlus = true;
+                if (game < poolGames) {
+                    isPlus = game % 2 == 0;
+                    tuned = std::make_shared<AutoPlayerAlgorithm>(isPlus ? plus : minus);
+                    other = pool[game / 2 / gamesPerOpponent]();
+                } else {
+                    tuned = std::make_shared<AutoPlayerAlgorithm>(plus);
+                    other = std::make_shared<AutoPlayerAlgorithm>(minus);
+                }
+                const bool first = (game / 2) % 2 == 0;
+                const auto winner = first ? gameManager.playRound(tuned, other).winner : gameManager.playRound(other, tuned).winner;
+                const int result = winner == 0 ? 0 : ((winner == 1) == first ? 1 : -1);
+                if (game >= poolGames) {
+                    plusScore += result;
+                    minusScore -= result;
+                } else {
+                    (isPlus ? plusScore : minusScore) += result;
+                }
+            }
+        };
+        std::vector<std::thread> threads;
+        for (unsigned int i = 0; i < numThreads; i++) threads.emplace_back(worker);
+        for (auto& thread : threads) thread.join();
+        totalGames += numGames;
+        const double gamesEach = numGames / 2.0 + gamesPerOpponent;
+        return { plusScore / gamesEach, minusScore / gamesEach };
+    }
+};
+
+static void outputParams(std::ostream& os, const AutoParams& params) {
+    for (const auto& field : AutoParams::fields()) os << " " << field.name << "=" << params.*field.member;
+}
+
+// usage: tune [-path dir] [-threads n] [-iterations n] [-games n] [-params file] [-out file] [-save_every n]
+//   plays against the player libraries of dir, starting from the parameters of -params (the defaults
+//   without it) and periodically writes the tuned ones to -out, for AutoPlayerAlgorithm to read from $RPS_PARAMS
+int main(int argc, char *argv[]) {
+    std::string path = "./";
+    std::string inFile;
+    std::string outFile = "rps.params";
+    unsigned int iterations = 1000;
+    unsigned int saveEvery = 10;
+    Tuner tuner;
+    std::vector<std::string> vec(argv + 1, argv + argc);
+    vec.push_back(""); // to make is possible to itetate until vec.size() - 1
+    for (unsigned int i = 0; i < vec.size() - 1; i++) {
+        if (vec[i] == "-path") {
+            path = vec[i + 1];
+        } else if (vec[i] == "-threads") {
+            tuner.numThreads = std::max(1ul, std::stoul(vec[i + 1]));
+        } else if (vec[i] == "-iterations") {
+            iterations = std::stoul(vec[i + 1]);
+        } else if (vec[i] == "-games") {
+            tuner.gamesPerOpponent = std::max(1ul, std::stoul(vec[i + 1]));
+        } else if (vec[i] == "-params") {
+            inFile = vec[i + 1];
+        } else if (vec[i] == "-out") {
+            outFile = vec[i + 1];
+        } else if (vec[i] == "-save_every") {
+            saveEvery = std::max(1ul, std::stoul(vec[i + 1]));
+        }
+    }
+    // libraries stay loaded until the process exits
+    const std::string prefix = "RSPPlayer_";
+    std::error_code ec;
+    for (const auto& file : fs::directory_iterator(path, ec)) {
+        const auto name = file.path().filename().string();
+        if (name.compare(0, prefix.length(), prefix) != 0 || file.path().extension() != ".so") continue;
+        if (!dlopen(file.path().c_str(), RTLD_NOW | RTLD_LOCAL)) std::cout << "ERROR: " << dlerror() << std::endl;
+    }
+    for (const auto& opponent : opponents()) tuner.pool.push_back(opponent.second);
+    AutoParams params;
+    if (!inFile.empty() && !params.load(inFile)) {
+        std::cout << "ERROR: can't read parameters '" << inFile << "'" << std::endl;
+        return 1;
+    }
+    const auto& fields = AutoParams::fields();
+    std::vector<double> theta; // in steps
+    for (const auto& field : fields) theta.push_back(params.*field.member / field.step);
+    auto toParams = [&](const std::vector<double>& units) {
+        AutoParams result;
+        for (unsigned int i = 0; i < fields.size(); i++) {
+            result.*fields[i].member = std::min(std::max(units[i] * fields[i].step, fields[i].min), fields[i].max);
+        }
+        return result;
+    };
+    std::cerr << "tuning " << fields.size() << " parameters against " << tuner.pool.size() << " opponents with "
+        << tuner.numThreads << " threads" << std::endl;
+    std::mt19937 rg{ std::random_device{}() };
+    const double stability = iterations / 10.0;
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned int k = 0; k < iterations; k++) {
+        const double a = GAIN_A * std::pow(1 + stability, ALPHA) / std::pow(k + 1 + stability, ALPHA);
+        const double c = GAIN_C / std::pow(k + 1, GAMMA);
+        std::vector<double> delta(fields.size());
+        for (auto& sign : delta) sign = std::bernoulli_distribution()(rg) ? 1 : -1;
+        auto plus = theta;
+        auto minus = theta;
+        for (unsigned int i = 0; i < fields.size(); i++) {
+            plus[i] += c * delta[i];
+            minus[i] -= c * delta[i];
+        }
+        const auto scores = tuner.play(toParams(plus), toParams(minus));
+        for (unsigned int i = 0; i < fields.size(); i++) {
+            theta[i] += a * (scores.first - scores.second) / (2 * c * delta[i]);
+            // kept where the clamped parameters still change, or it drifts without an effect
+            theta[i] = std::min(std::max(theta[i], fields[i].min / fields[i].step), fields[i].max / fields[i].step);
+        }
+        params = toParams(theta);
+        const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cerr << "iteration " << k + 1 << " games " << tuner.totalGames << " (" << std::fixed << std::setprecision(0)
+            << tuner.totalGames / seconds << "/sec) score " << std::setprecision(3) << scores.first << " " << scores.second
+            << std::defaultfloat;
+        outputParams(std::cerr, params);
+        std::cerr << std::endl;
+        if ((k + 1) % saveEvery == 0 || k + 1 == iterations) {
+            if (!params.save(outFile)) std::cout << "ERROR: can't write parameters '" << outFile << "'" << std::endl;
+        }
+    }
+    return 0;
+}